@@ -7,16 +7,15 @@ layout(location = 0) out vec4 o_Color;
 in vec2 v_TexCoord;
 
 /* Uniforms */
-uniform sampler2D u_Texture[2];
+layout(binding = 0) uniform sampler2D u_Texture; // Stencil
 
 void main() {
-    vec4 world = texture(u_Texture[1], v_TexCoord);
-    vec4 stencil = texture(u_Texture[0], v_TexCoord);
+    vec4 stencil = texture(u_Texture, v_TexCoord);
     
     if (stencil.rgb == vec3(0.0)) {
         discard;
     }
 
-    /* Invert the color */
-    o_Color = vec4(1.0f - world.r, 1.0f - world.g, 1.0f - world.b, 1.0f);
-}
\ No newline at end of file
+    /* White, the blend function turns it into the inverse of the framebuffer */
+    o_Color = vec4(1.0f);
+}
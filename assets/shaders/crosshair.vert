@@ -1,13 +1,20 @@
-#version 330 core
+#version 420 core
 layout (location = 0) in vec2 a_Position;
 layout (location = 1) in vec2 a_TexCoord;
 
-uniform mat4 u_Projection;
-uniform mat4 u_Model;
+/* Per frame camera data, see CameraUniforms */
+layout(std140, binding = 0) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    mat4 u_ViewProjection;
+    mat4 u_ScreenProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Viewport;
+};
 
 out vec2 v_TexCoord;
 
 void main() {
-    gl_Position = u_Projection * u_Model * vec4(a_Position, 0.0, 1.0);
+    gl_Position = u_ScreenProjection * vec4(a_Position, 0.0, 1.0);
     v_TexCoord = a_TexCoord;
 }
\ No newline at end of file
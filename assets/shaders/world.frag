@@ -8,10 +8,12 @@ in vec3 v_Color;
 in vec3 v_Normal;
 in vec3 v_Position;
 in vec2 v_TexCoord;
+flat in float v_Layer;
 
 /* Uniforms */
-uniform sampler2D u_Texture;
+layout(binding = 0) uniform sampler2DArray u_Texture; // One block texture per layer
 
 void main() {
-    o_Color = vec4(v_Color, 1.0) * texture(u_Texture, v_TexCoord);
+    /* Layers wrap on their own, so merged faces simply repeat */
+    o_Color = vec4(v_Color, 1.0) * texture(u_Texture, vec3(v_TexCoord, v_Layer));
 }
\ No newline at end of file
@@ -1,27 +1,65 @@
 #version 420 core
 
 /* Vertex Shader Inputs */
-layout(location = 0) in vec3 a_Position;
-layout(location = 1) in vec3 a_Normal;
-layout(location = 2) in vec3 a_Color;
-layout(location = 3) in vec2 a_TexCoord;
+layout(location = 0) in uint a_Position; // x | z << 5 | y << 10 | face << 19, chunk local
+layout(location = 1) in uint a_Material; // layer | tint << 8
+layout(location = 2) in vec3 a_ChunkOrigin; // Per draw, fetched through the base instance
 
-/* Vertex Shader Outputs */
-uniform mat4 u_Projection;
-uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_NormalMatrix;
+/* Per frame camera data, see CameraUniforms */
+layout(std140, binding = 0) uniform Camera {
+    mat4 u_Projection;
+    mat4 u_View;
+    mat4 u_ViewProjection;
+    mat4 u_ScreenProjection;
+    vec4 u_CameraPosition;
+    vec4 u_Viewport;
+};
+
+/* Chunk and block data */
+uniform vec3 u_Tints[8];
 
 /* Fragment Shader Inputs */
 out vec3 v_Color;
 out vec3 v_Normal;
 out vec3 v_Position;
 out vec2 v_TexCoord;
+flat out float v_Layer;
+
+/* Face normals, in BlockFace order */
+const vec3 c_Normals[6] = vec3[](
+    vec3( 0.0,  0.0,  1.0),
+    vec3( 0.0,  0.0, -1.0),
+    vec3(-1.0,  0.0,  0.0),
+    vec3( 1.0,  0.0,  0.0),
+    vec3( 0.0,  1.0,  0.0),
+    vec3( 0.0, -1.0,  0.0)
+);
 
 void main() {
-    gl_Position = u_Projection * u_View * u_Model * vec4(a_Position, 1.0);
-    v_Color = a_Color;
-    v_Normal = mat3(u_NormalMatrix) * a_Normal;
-    v_Position = vec3(u_Model * vec4(a_Position, 1.0));
-    v_TexCoord = a_TexCoord;
+    /* Unpack vertex */
+    vec3 local = vec3(a_Position & 31u, (a_Position >> 10) & 511u, (a_Position >> 5) & 31u);
+    uint face = (a_Position >> 19) & 7u;
+    uint layer = a_Material & 255u;
+    uint tint = (a_Material >> 8) & 7u;
+
+    /* Texture coordinates follow the face axes, so merged faces repeat the layer */
+    vec2 texcoord;
+    switch (face) {
+    case 0u: texcoord = vec2( local.x,  local.y); break;
+    case 1u: texcoord = vec2(-local.x,  local.y); break;
+    case 2u: texcoord = vec2( local.z,  local.y); break;
+    case 3u: texcoord = vec2(-local.z,  local.y); break;
+    case 4u: texcoord = vec2( local.x, -local.z); break;
+    default: texcoord = vec2(-local.x, -local.z); break;
+    }
+
+    vec3 position = a_ChunkOrigin + local;
+    vec3 normal = c_Normals[face];
+
+    gl_Position = u_ViewProjection * vec4(position, 1.0);
+    v_Color = u_Tints[tint];
+    v_Normal = normal;
+    v_Position = position;
+    v_TexCoord = texcoord;
+    v_Layer = float(layer);
 }
\ No newline at end of file
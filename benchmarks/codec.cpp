@@ -0,0 +1,241 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+
+#include "codec.h"
+
+/*
+ * Compresses a region's worth of generated chunks with the block codec and
+ * with the LZ stage alone, and reports the compression ratio and how many
+ * uncompressed MB per second each direction gets through on one thread.
+ *
+ * Usage: codec_benchmark [chunk height]
+ */
+
+constexpr int CHUNK_WIDTH = 16;
+constexpr int CHUNK_DEPTH = 16;
+constexpr int REGION_CHUNKS = 32;
+
+/* Each measurement repeats until it has run for at least this long */
+constexpr double MIN_SECONDS = 0.25;
+
+using Generator = std::function<BlockType(int x, int y, int z, int height)>;
+
+static uint32_t Hash(int x, int y, int z) {
+	uint32_t h = static_cast<uint32_t>(x) * 73856093u ^ static_cast<uint32_t>(y) * 19349663u ^ static_cast<uint32_t>(z) * 83492791u;
+	h ^= h >> 13;
+	h *= 0x5bd1e995u;
+	return h ^ (h >> 15);
+}
+
+/* Smooth value noise in [0, 1] over a lattice of the given cell size */
+static float Noise(int x, int z, int cell) {
+	const int cx = x >= 0 ? x / cell : (x - cell + 1) / cell;
+	const int cz = z >= 0 ? z / cell : (z - cell + 1) / cell;
+	const float fx = static_cast<float>(x - cx * cell) / cell;
+	const float fz = static_cast<float>(z - cz * cell) / cell;
+
+	auto corner = [](int x, int z) { return (Hash(x, 0, z) & 0xffff) / 65535.0f; };
+	const float sx = fx * fx * (3.0f - 2.0f * fx);
+	const float sz = fz * fz * (3.0f - 2.0f * fz);
+	const float top = corner(cx, cz) + (corner(cx + 1, cz) - corner(cx, cz)) * sx;
+	const float bottom = corner(cx, cz + 1) + (corner(cx + 1, cz + 1) - corner(cx, cz + 1)) * sx;
+	return top + (bottom - top) * sz;
+}
+
+/* Layers like the flat world generator, scaled to the chunk height */
+static BlockType FlatWorld(int /*x*/, int y, int /*z*/, int height) {
+	const int ground = height / 2;
+	if (y == 0) {
+		return BlockType::BEDROCK;
+	}
+
+	if (y < ground - 4) {
+		return BlockType::STONE;
+	}
+
+	if (y < ground) {
+		return BlockType::DIRT;
+	}
+
+	return y == ground ? BlockType::GRASS : BlockType::AIR;
+}
+
+/* Rolling hills with caves, scattered cobblestone and the odd tree */
+static BlockType TerrainWorld(int x, int y, int z, int height) {
+	const int ground = static_cast<int>(height * (0.3f + 0.3f * Noise(x, z, 24) + 0.05f * Noise(x, z, 5)));
+	const uint32_t random = Hash(x, y, z);
+
+	if (y == 0 || (y < 3 && (random & 3) == 0)) {
+		return BlockType::BEDROCK;
+	}
+
+	if (y > ground) {
+		/* Trunks on a sparse grid of columns, a block of leaves around the top */
+		const bool tree = (Hash(x, 0, z) & 127) == 0;
+		if (tree && y <= ground + 4) {
+			return BlockType::WOOD;
+		}
+
+		for (int dx = -2; dx <= 2; dx++) {
+			for (int dz = -2; dz <= 2; dz++) {
+				if ((Hash(x + dx, 0, z + dz) & 127) == 0) {
+					const int top = static_cast<int>(height * (0.3f + 0.3f * Noise(x + dx, z + dz, 24) + 0.05f * Noise(x + dx, z + dz, 5))) + 5;
+					if (y >= top - 2 && y <= top) {
+						return BlockType::LEAVES;
+					}
+				}
+			}
+		}
+
+		return BlockType::AIR;
+	}
+
+	if (Noise(x + y * 7, z - y * 5, 9) > 0.78f && y < ground - 3) {
+		return BlockType::AIR;
+	}
+
+	if (y == ground) {
+		return BlockType::GRASS;
+	}
+
+	if (y > ground - 4) {
+		return BlockType::DIRT;
+	}
+
+	return (random % 100) == 0 ? BlockType::COBBLESTONE : BlockType::STONE;
+}
+
+/* Every block random, the worst case */
+static BlockType NoiseWorld(int x, int y, int z, int /*height*/) {
+	return static_cast<BlockType>(Hash(x, y, z) % BLOCK_TYPE_COUNT);
+}
+
+static std::vector<std::vector<BlockType>> GenerateRegion(const Generator& generator, int height) {
+	std::vector<std::vector<BlockType>> chunks;
+	for (int cz = 0; cz < REGION_CHUNKS; cz++) {
+		for (int cx = 0; cx < REGION_CHUNKS; cx++) {
+			std::vector<BlockType> blocks(static_cast<size_t>(CHUNK_WIDTH) * height * CHUNK_DEPTH);
+			for (int z = 0; z < CHUNK_DEPTH; z++) {
+				for (int y = 0; y < height; y++) {
+					for (int x = 0; x < CHUNK_WIDTH; x++) {
+						blocks[x + y * CHUNK_WIDTH + z * CHUNK_WIDTH * height] = generator(cx * CHUNK_WIDTH + x, y, cz * CHUNK_DEPTH + z, height);
+					}
+				}
+			}
+
+			chunks.push_back(std::move(blocks));
+		}
+	}
+
+	return chunks;
+}
+
+/* Runs fn until MIN_SECONDS have passed, returns seconds per run */
+static double Measure(const std::function<void()>& fn) {
+	using Clock = std::chrono::steady_clock;
+
+	size_t runs = 0;
+	const Clock::time_point start = Clock::now();
+	double elapsed = 0.0;
+	do {
+		fn();
+		runs++;
+		elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	} while (elapsed < MIN_SECONDS);
+
+	return elapsed / runs;
+}
+
+static void Report(const char* world, const char* codec, size_t raw, size_t compressed, double compress, double decompress) {
+	std::printf(
+		"%-10s %-8s %10.2f %10.1f %14.1f %16.1f\n",
+		world, codec, raw / 1e6, static_cast<double>(raw) / compressed, raw / 1e6 / compress, raw / 1e6 / decompress
+	);
+}
+
+int main(int argc, char** argv) {
+	const int height = argc > 1 ? std::atoi(argv[1]) : 128;
+	if (height <= 0) {
+		std::fprintf(stderr, "Chunk height must be positive\n");
+		return 1;
+	}
+
+	const std::pair<const char*, Generator> worlds[] = {
+		{ "flat", FlatWorld },
+		{ "terrain", TerrainWorld },
+		{ "noise", NoiseWorld },
+	};
+
+	std::printf("%d chunks of %dx%dx%d per world\n\n", REGION_CHUNKS * REGION_CHUNKS, CHUNK_WIDTH, height, CHUNK_DEPTH);
+	std::printf("%-10s %-8s %10s %10s %14s %16s\n", "world", "codec", "raw MB", "ratio", "compress MB/s", "decompress MB/s");
+
+	int failures = 0;
+	for (const auto& [name, generator] : worlds) {
+		const std::vector<std::vector<BlockType>> chunks = GenerateRegion(generator, height);
+		const size_t volume = chunks[0].size();
+		const size_t raw = volume * chunks.size();
+
+		std::vector<std::vector<unsigned char>> payloads(chunks.size());
+		std::vector<BlockType> decoded(volume);
+
+		/* Palette and layer runs, then LZ */
+		const double block_compress = Measure([&]() {
+			for (size_t i = 0; i < chunks.size(); i++) {
+				payloads[i].clear();
+				CompressBlocks(chunks[i].data(), CHUNK_WIDTH, height, CHUNK_DEPTH, payloads[i]);
+			}
+		});
+
+		size_t compressed = 0;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			compressed += payloads[i].size();
+			if (!DecompressBlocks(payloads[i].data(), payloads[i].size(), CHUNK_WIDTH, height, CHUNK_DEPTH, decoded.data()) || decoded != chunks[i]) {
+				failures++;
+			}
+		}
+
+		const double block_decompress = Measure([&]() {
+			for (size_t i = 0; i < chunks.size(); i++) {
+				DecompressBlocks(payloads[i].data(), payloads[i].size(), CHUNK_WIDTH, height, CHUNK_DEPTH, decoded.data());
+			}
+		});
+
+		Report(name, "blocks", raw, compressed, block_compress, block_decompress);
+
+		/* LZ straight on the block bytes, for comparison */
+		const double lz_compress = Measure([&]() {
+			for (size_t i = 0; i < chunks.size(); i++) {
+				payloads[i].clear();
+				CompressLZ(reinterpret_cast<const unsigned char*>(chunks[i].data()), volume, payloads[i]);
+			}
+		});
+
+		compressed = 0;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			compressed += payloads[i].size();
+			if (!DecompressLZ(payloads[i].data(), payloads[i].size(), reinterpret_cast<unsigned char*>(decoded.data()), volume) || decoded != chunks[i]) {
+				failures++;
+			}
+		}
+
+		const double lz_decompress = Measure([&]() {
+			for (size_t i = 0; i < chunks.size(); i++) {
+				DecompressLZ(payloads[i].data(), payloads[i].size(), reinterpret_cast<unsigned char*>(decoded.data()), volume);
+			}
+		});
+
+		Report(name, "lz", raw, compressed, lz_compress, lz_decompress);
+	}
+
+	if (failures != 0) {
+		std::fprintf(stderr, "\n%d chunks did not decompress to what was compressed\n", failures);
+		return 1;
+	}
+
+	return 0;
+}
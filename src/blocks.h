@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+enum class BlockType : uint8_t {
+	AIR = 0,
+	DIRT,
+	GRASS,
+	STONE,
+	WOOD,
+	LEAVES,
+	COBBLESTONE,
+	BEDROCK,
+};
+
+constexpr int BLOCK_TYPE_COUNT = static_cast<int>(BlockType::BEDROCK) + 1;
+
+enum class BlockFace {
+	FRONT = 0,
+	BACK,
+	LEFT,
+	RIGHT,
+	TOP,
+	BOTTOM,
+};
+
+constexpr int BLOCK_FACE_COUNT = static_cast<int>(BlockFace::BOTTOM) + 1;
+
+enum class BlockTint : uint8_t {
+	NONE = 0,
+	FOLIAGE,
+	OVERLAY,
+};
+
+constexpr int BLOCK_TINT_COUNT = static_cast<int>(BlockTint::OVERLAY) + 1;
+
+/* Tiles per row and column of the terrain atlas */
+constexpr int ATLAS_TILE_COUNT = 16;
+
+/* Tile of faces without a texture, such as missing overlays */
+constexpr int NO_TILE = -1;
+
+struct BlockTexture {
+	int tile;
+	BlockTint tint;
+};
+
+constexpr BlockTexture NO_TEXTURE = { NO_TILE, BlockTint::NONE };
+
+/* One texture per face, in BlockFace order */
+using BlockFaceTextures = std::array<BlockTexture, BLOCK_FACE_COUNT>;
+
+struct BlockInfo {
+	const char* name;
+	BlockFaceTextures textures;
+	BlockFaceTextures overlays; // Drawn over the base texture, NO_TILE where there is none
+	bool opaque;                // Hides the faces of blocks next to it
+	bool solid;                 // Stops raycasts
+};
+
+/* Same texture on every face */
+constexpr BlockFaceTextures UniformFaces(BlockTexture texture) {
+	return { texture, texture, texture, texture, texture, texture };
+}
+
+/* Sides, top and bottom textures */
+constexpr BlockFaceTextures ColumnFaces(BlockTexture side, BlockTexture top, BlockTexture bottom) {
+	return { side, side, side, side, top, bottom };
+}
+
+/*
+ * Every block's properties, in BlockType order. Adding a block means adding
+ * an enum value and a row here; meshing, raycasts and scripts read the rest
+ * from this table.
+ */
+constexpr BlockInfo BLOCK_REGISTRY[] = {
+	/* name, textures, overlays, opaque, solid */
+	{ "AIR", UniformFaces({ 31, BlockTint::NONE }), UniformFaces(NO_TEXTURE), false, false },
+	{ "DIRT", UniformFaces({ 2, BlockTint::NONE }), UniformFaces(NO_TEXTURE), true, true },
+	{
+		"GRASS",
+		ColumnFaces({ 3, BlockTint::NONE }, { 0, BlockTint::FOLIAGE }, { 2, BlockTint::NONE }),
+		ColumnFaces({ 38, BlockTint::OVERLAY }, NO_TEXTURE, NO_TEXTURE),
+		true, true
+	},
+	{ "STONE", UniformFaces({ 1, BlockTint::NONE }), UniformFaces(NO_TEXTURE), true, true },
+	{ "WOOD", ColumnFaces({ 20, BlockTint::NONE }, { 21, BlockTint::NONE }, { 21, BlockTint::NONE }), UniformFaces(NO_TEXTURE), true, true },
+	{ "LEAVES", UniformFaces({ 53, BlockTint::FOLIAGE }), UniformFaces(NO_TEXTURE), true, true },
+	{ "COBBLESTONE", UniformFaces({ 16, BlockTint::NONE }), UniformFaces(NO_TEXTURE), true, true },
+	{ "BEDROCK", UniformFaces({ 17, BlockTint::NONE }), UniformFaces(NO_TEXTURE), true, true },
+};
+
+static_assert(sizeof(BLOCK_REGISTRY) / sizeof(BlockInfo) == BLOCK_TYPE_COUNT, "every block type needs a registry entry");
+static_assert(BLOCK_TYPE_COUNT <= 32, "the binary greedy mesher keeps a 32 bit mask of the materials in a plane");
+
+/* Lookups, one indexed load each */
+constexpr const BlockInfo& GetBlockInfo(BlockType type) {
+	return BLOCK_REGISTRY[static_cast<size_t>(type)];
+}
+
+constexpr const char* BlockTypeToString(BlockType type) {
+	return GetBlockInfo(type).name;
+}
+
+constexpr BlockTexture GetBlockTexture(BlockType type, BlockFace face) {
+	return GetBlockInfo(type).textures[static_cast<size_t>(face)];
+}
+
+constexpr BlockTexture GetBlockOverlay(BlockType type, BlockFace face) {
+	return GetBlockInfo(type).overlays[static_cast<size_t>(face)];
+}
+
+constexpr bool HasBlockOverlay(BlockType type, BlockFace face) {
+	return GetBlockOverlay(type, face).tile != NO_TILE;
+}
+
+constexpr bool IsBlockOpaque(BlockType type) {
+	return GetBlockInfo(type).opaque;
+}
+
+constexpr bool IsBlockSolid(BlockType type) {
+	return GetBlockInfo(type).solid;
+}
@@ -0,0 +1,78 @@
+#include "cache.h"
+
+ChunkCache::ChunkCache(size_t capacity, bool keep_meshes)
+	: m_Capacity(capacity), m_KeepMeshes(keep_meshes), m_Bytes(0), m_Hits(0), m_Misses(0), m_Evictions(0) {}
+
+void ChunkCache::Erase(std::list<Entry>::iterator entry) {
+	m_Bytes -= entry->size;
+	m_Index.erase(PackChunkKey(entry->chunk.GetPosition()));
+	m_Entries.erase(entry);
+}
+
+void ChunkCache::Insert(Chunk&& chunk, ChunkMeshData&& mesh) {
+	auto existing = m_Index.find(PackChunkKey(chunk.GetPosition()));
+	if (existing != m_Index.end()) {
+		Erase(existing->second);
+	}
+
+	if (!m_KeepMeshes) {
+		mesh = {};
+	}
+
+	/* GPU meshes belong to the arena, only blocks and CPU geometry are kept */
+	chunk.ClearMesh();
+
+	const size_t size = sizeof(Entry) + chunk.GetMemoryUsage() + mesh.GetSize();
+	if (size > m_Capacity) {
+		return;
+	}
+
+	const glm::ivec2 position = chunk.GetPosition();
+	m_Entries.push_front({ std::move(chunk), std::move(mesh), size });
+	m_Index[PackChunkKey(position)] = m_Entries.begin();
+	m_Bytes += size;
+
+	while (m_Bytes > m_Capacity) {
+		Erase(std::prev(m_Entries.end()));
+		m_Evictions++;
+	}
+}
+
+std::optional<Chunk> ChunkCache::Take(glm::ivec2 position, ChunkMeshData* mesh) {
+	auto it = m_Index.find(PackChunkKey(position));
+	if (it == m_Index.end()) {
+		m_Misses++;
+		return std::nullopt;
+	}
+
+	m_Hits++;
+
+	Entry& entry = *it->second;
+	std::optional<Chunk> chunk(std::move(entry.chunk));
+	if (mesh != nullptr) {
+		*mesh = std::move(entry.mesh);
+	}
+
+	Erase(it->second);
+	return chunk;
+}
+
+bool ChunkCache::Contains(glm::ivec2 position) const {
+	return m_Index.count(PackChunkKey(position)) != 0;
+}
+
+void ChunkCache::Clear() {
+	m_Entries.clear();
+	m_Index.clear();
+	m_Bytes = 0;
+}
+
+ChunkCacheStats ChunkCache::GetStats() const {
+	ChunkCacheStats stats;
+	stats.hits = m_Hits;
+	stats.misses = m_Misses;
+	stats.evictions = m_Evictions;
+	stats.entries = m_Entries.size();
+	stats.bytes = m_Bytes;
+	return stats;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <list>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "world.h"
+#include "chunks.h"
+#include "meshing.h"
+
+struct ChunkCacheStats {
+	size_t hits = 0;      // Chunks taken back out, since start
+	size_t misses = 0;    // Chunks asked for that weren't there, since start
+	size_t evictions = 0; // Chunks dropped to stay under the memory limit, since start
+	size_t entries = 0;
+	size_t bytes = 0;     // Memory held by the entries
+};
+
+/*
+ * Recently unloaded chunks, kept so a chunk coming back into range doesn't
+ * have to be generated again. Chunks go in without their GPU meshes, the
+ * CPU side mesh can go with them when the cache keeps meshes, so a chunk
+ * that comes back can be drawn again without meshing it either. Once the
+ * entries take more than the memory limit the least recently inserted go
+ * first. Meshes are only as fresh as the revisions they carry, check them
+ * against the chunk and its neighbours before using one.
+ */
+class ChunkCache {
+private:
+	struct Entry {
+		Chunk chunk;
+		ChunkMeshData mesh;
+		size_t size;
+	};
+
+	std::list<Entry> m_Entries; // Most recently inserted first
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> m_Index;
+
+	size_t m_Capacity;
+	bool m_KeepMeshes;
+	size_t m_Bytes;
+	size_t m_Hits;
+	size_t m_Misses;
+	size_t m_Evictions;
+
+	void Erase(std::list<Entry>::iterator entry);
+
+public:
+	/* Zero capacity caches nothing */
+	ChunkCache(size_t capacity, bool keep_meshes = false);
+
+	/* Delete copying */
+	ChunkCache(const ChunkCache&) = delete;
+	ChunkCache& operator=(const ChunkCache&) = delete;
+
+	/* Store an unloaded chunk, replacing any entry at its position. Meshes are dropped unless the cache keeps them */
+	void Insert(Chunk&& chunk, ChunkMeshData&& mesh = {});
+
+	/* Remove and return the chunk at a position, along with its mesh if mesh isn't null */
+	std::optional<Chunk> Take(glm::ivec2 position, ChunkMeshData* mesh = nullptr);
+
+	bool Contains(glm::ivec2 position) const;
+	void Clear();
+
+	inline bool KeepsMeshes() const { return m_KeepMeshes; }
+	inline size_t GetCapacity() const { return m_Capacity; }
+	ChunkCacheStats GetStats() const;
+};
@@ -3,6 +3,21 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+/* Uniform block binding point of the Camera block declared by the shaders */
+constexpr unsigned int CAMERA_UNIFORM_BINDING = 0;
+
+/* Per frame camera data, laid out to match the std140 Camera block */
+struct CameraUniforms {
+	glm::mat4 projection;
+	glm::mat4 view;
+	glm::mat4 viewProjection;
+	glm::mat4 screenProjection; // Pixel coordinates, origin at the bottom left
+	glm::vec4 position;         // xyz, w unused
+	glm::vec4 viewport;         // width, height, 1 / width, 1 / height
+};
+
+static_assert(sizeof(CameraUniforms) == 4 * sizeof(glm::mat4) + 2 * sizeof(glm::vec4), "camera uniforms must match std140");
+
 class Camera {
 private:
 	glm::vec3 m_Position;
@@ -0,0 +1,284 @@
+#include "chunks.h"
+
+ChunkMap::ChunkMap() : m_Count(0) {
+	Rehash(64);
+}
+
+uint64_t ChunkMap::HashKey(uint64_t key) {
+	/* splitmix64 finalizer, neighbouring coordinates spread across the table */
+	key ^= key >> 30;
+	key *= 0xbf58476d1ce4e5b9ULL;
+	key ^= key >> 27;
+	key *= 0x94d049bb133111ebULL;
+	key ^= key >> 31;
+	return key;
+}
+
+size_t ChunkMap::FindBucket(uint64_t key) const {
+	size_t mask = m_Buckets.size() - 1;
+	size_t bucket = HashKey(key) & mask;
+
+	/* Linear probe until an empty bucket is hit */
+	while (m_Buckets[bucket].slot != EMPTY_SLOT) {
+		if (m_Buckets[bucket].key == key) {
+			return bucket;
+		}
+
+		bucket = (bucket + 1) & mask;
+	}
+
+	return NOT_FOUND;
+}
+
+void ChunkMap::InsertBucket(uint64_t key, uint32_t slot) {
+	size_t mask = m_Buckets.size() - 1;
+	size_t bucket = HashKey(key) & mask;
+
+	while (m_Buckets[bucket].slot != EMPTY_SLOT) {
+		bucket = (bucket + 1) & mask;
+	}
+
+	m_Buckets[bucket] = { key, slot };
+}
+
+void ChunkMap::EraseBucket(size_t bucket) {
+	size_t mask = m_Buckets.size() - 1;
+	size_t hole = bucket;
+
+	/* Backward shift deletion, keeps probe sequences intact without tombstones */
+	for (size_t next = (hole + 1) & mask; m_Buckets[next].slot != EMPTY_SLOT; next = (next + 1) & mask) {
+		size_t home = HashKey(m_Buckets[next].key) & mask;
+
+		/* Move the entry back if its home isn't cyclically within (hole, next] */
+		bool movable = (hole <= next) ? (home <= hole || home > next) : (home <= hole && home > next);
+		if (movable) {
+			m_Buckets[hole] = m_Buckets[next];
+			hole = next;
+		}
+	}
+
+	m_Buckets[hole].slot = EMPTY_SLOT;
+}
+
+void ChunkMap::Rehash(size_t capacity) {
+	std::vector<Bucket> old = std::move(m_Buckets);
+	m_Buckets.assign(capacity, { 0, EMPTY_SLOT });
+
+	for (const auto& bucket : old) {
+		if (bucket.slot != EMPTY_SLOT) {
+			InsertBucket(bucket.key, bucket.slot);
+		}
+	}
+}
+
+ChunkHandle ChunkMap::Insert(Chunk&& chunk) {
+	uint64_t key = PackChunkKey(chunk.GetPosition());
+
+	/* Replace in place if already loaded */
+	size_t existing = FindBucket(key);
+	if (existing != NOT_FOUND) {
+		Slot& slot = m_Slots[m_Buckets[existing].slot];
+		slot.chunk.reset();
+		slot.chunk.emplace(std::move(chunk));
+		slot.generation++;
+
+		return { m_Buckets[existing].slot, slot.generation };
+	}
+
+	/* Keep load factor under one half */
+	if ((m_Count + 1) * 2 > m_Buckets.size()) {
+		Rehash(m_Buckets.size() * 2);
+	}
+
+	/* Reuse a free slot if possible */
+	uint32_t index;
+	if (!m_FreeSlots.empty()) {
+		index = m_FreeSlots.back();
+		m_FreeSlots.pop_back();
+	} else {
+		index = static_cast<uint32_t>(m_Slots.size());
+		m_Slots.emplace_back();
+	}
+
+	Slot& slot = m_Slots[index];
+	slot.chunk.emplace(std::move(chunk));
+
+	InsertBucket(key, index);
+	m_Count++;
+
+	return { index, slot.generation };
+}
+
+bool ChunkMap::Erase(glm::ivec2 position) {
+	size_t bucket = FindBucket(PackChunkKey(position));
+	if (bucket == NOT_FOUND) {
+		return false;
+	}
+
+	/* Invalidate outstanding handles */
+	uint32_t index = m_Buckets[bucket].slot;
+	m_Slots[index].chunk.reset();
+	m_Slots[index].generation++;
+	m_FreeSlots.push_back(index);
+
+	EraseBucket(bucket);
+	m_Count--;
+
+	return true;
+}
+
+void ChunkMap::Clear() {
+	for (uint32_t i = 0; i < m_Slots.size(); i++) {
+		if (m_Slots[i].chunk.has_value()) {
+			m_Slots[i].chunk.reset();
+			m_Slots[i].generation++;
+			m_FreeSlots.push_back(i);
+		}
+	}
+
+	for (auto& bucket : m_Buckets) {
+		bucket.slot = EMPTY_SLOT;
+	}
+
+	m_Count = 0;
+}
+
+Chunk* ChunkMap::Find(glm::ivec2 position) {
+	size_t bucket = FindBucket(PackChunkKey(position));
+	if (bucket == NOT_FOUND) {
+		return nullptr;
+	}
+
+	return &*m_Slots[m_Buckets[bucket].slot].chunk;
+}
+
+const Chunk* ChunkMap::Find(glm::ivec2 position) const {
+	size_t bucket = FindBucket(PackChunkKey(position));
+	if (bucket == NOT_FOUND) {
+		return nullptr;
+	}
+
+	return &*m_Slots[m_Buckets[bucket].slot].chunk;
+}
+
+ChunkHandle ChunkMap::GetHandle(glm::ivec2 position) const {
+	size_t bucket = FindBucket(PackChunkKey(position));
+	if (bucket == NOT_FOUND) {
+		return {};
+	}
+
+	uint32_t index = m_Buckets[bucket].slot;
+	return { index, m_Slots[index].generation };
+}
+
+Chunk* ChunkMap::Get(ChunkHandle handle) {
+	if (handle.index >= m_Slots.size()) {
+		return nullptr;
+	}
+
+	Slot& slot = m_Slots[handle.index];
+	if (slot.generation != handle.generation || !slot.chunk.has_value()) {
+		return nullptr;
+	}
+
+	return &*slot.chunk;
+}
+
+const Chunk* ChunkMap::Get(ChunkHandle handle) const {
+	if (handle.index >= m_Slots.size()) {
+		return nullptr;
+	}
+
+	const Slot& slot = m_Slots[handle.index];
+	if (slot.generation != handle.generation || !slot.chunk.has_value()) {
+		return nullptr;
+	}
+
+	return &*slot.chunk;
+}
+
+BlockType World::GetBlock(glm::ivec3 position) const {
+	const Chunk* chunk = m_Chunks.Find(glm::ivec2(position.x >> CHUNK_SHIFT, position.z >> CHUNK_SHIFT));
+	if (chunk == nullptr) {
+		return BlockType::AIR;
+	}
+
+	return chunk->GetBlock(position.x & CHUNK_MASK, position.y, position.z & CHUNK_MASK);
+}
+
+bool World::SetBlock(glm::ivec3 position, BlockType type) {
+	Chunk* chunk = m_Chunks.Find(glm::ivec2(position.x >> CHUNK_SHIFT, position.z >> CHUNK_SHIFT));
+	if (chunk == nullptr) {
+		return false;
+	}
+
+	return SetBlock(*chunk, position, type);
+}
+
+bool World::SetBlock(Chunk& chunk, glm::ivec3 position, BlockType type) {
+	const glm::ivec3 local = glm::ivec3(position.x & CHUNK_MASK, position.y, position.z & CHUNK_MASK);
+	if (local.y < 0 || local.y >= chunk.GetHeight()) {
+		return false;
+	}
+
+	/* Nothing to rebuild if the block is already there */
+	if (chunk.GetBlock(local.x, local.y, local.z) == type) {
+		return true;
+	}
+
+	chunk.SetBlock(local.x, local.y, local.z, type);
+
+	/* The block's section, plus the one across a section boundary */
+	const int section = local.y / SECTION_SIZE;
+	uint64_t sections = 1ULL << section;
+	if (local.y % SECTION_SIZE == 0 && section > 0) {
+		sections |= 1ULL << (section - 1);
+	}
+
+	if (local.y % SECTION_SIZE == SECTION_SIZE - 1 && section + 1 < chunk.GetSectionCount()) {
+		sections |= 1ULL << (section + 1);
+	}
+
+	MarkDirty(chunk.GetPosition(), sections);
+
+	/* Blocks on a chunk border show or hide faces of the neighbour's section */
+	const glm::ivec2 position2D = chunk.GetPosition();
+	if (local.x == 0) {
+		MarkDirty(position2D + glm::ivec2(-1, 0), 1ULL << section);
+	} else if (local.x == CHUNK_MASK) {
+		MarkDirty(position2D + glm::ivec2(1, 0), 1ULL << section);
+	}
+
+	if (local.z == 0) {
+		MarkDirty(position2D + glm::ivec2(0, -1), 1ULL << section);
+	} else if (local.z == CHUNK_MASK) {
+		MarkDirty(position2D + glm::ivec2(0, 1), 1ULL << section);
+	}
+
+	return true;
+}
+
+size_t World::SetBlocks(const std::vector<BlockEdit>& edits) {
+	/* Edits usually come in clusters, so keep the last chunk around */
+	Chunk* chunk = nullptr;
+	glm::ivec2 current = glm::ivec2(0);
+
+	size_t applied = 0;
+	for (const BlockEdit& edit : edits) {
+		glm::ivec2 position = glm::ivec2(edit.position.x >> CHUNK_SHIFT, edit.position.z >> CHUNK_SHIFT);
+		if (chunk == nullptr || position != current) {
+			chunk = m_Chunks.Find(position);
+			current = position;
+		}
+
+		if (chunk != nullptr && SetBlock(*chunk, edit.position, edit.type)) {
+			applied++;
+		}
+	}
+
+	return applied;
+}
+
+void World::MarkDirty(glm::ivec2 position, uint64_t sections) {
+	m_Dirty.try_emplace(PackChunkKey(position), DirtyChunk{ position, 0 }).first->second.sections |= sections;
+}
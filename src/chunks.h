@@ -0,0 +1,204 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <iterator>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include "world.h"
+
+/* World x and z split into a chunk position and a position inside it with a shift and a mask */
+constexpr int CHUNK_SHIFT = 4;
+constexpr int CHUNK_MASK = SECTION_SIZE - 1;
+
+static_assert(1 << CHUNK_SHIFT == SECTION_SIZE, "chunks are split off world coordinates with shifts");
+
+/* Hash map key of a chunk position, x in the high half and z in the low */
+inline uint64_t PackChunkKey(glm::ivec2 position) {
+	return (static_cast<uint64_t>(static_cast<uint32_t>(position.x)) << 32) | static_cast<uint32_t>(position.y);
+}
+
+/* Stable reference to a chunk stored inside a ChunkMap */
+struct ChunkHandle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	inline bool IsValid() const { return index != UINT32_MAX; }
+};
+
+class ChunkMap {
+private:
+	/* Chunk storage, slots are reused after removal */
+	struct Slot {
+		std::optional<Chunk> chunk;
+		uint32_t generation = 0;
+	};
+
+	/* Open addressing bucket, pointing into the slot array */
+	struct Bucket {
+		uint64_t key;
+		uint32_t slot;
+	};
+
+	static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+	static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+	std::vector<Bucket> m_Buckets;
+	size_t m_Count;
+
+	/* Hashing */
+	static uint64_t HashKey(uint64_t key);
+
+	/* Bucket helpers */
+	size_t FindBucket(uint64_t key) const;
+	void InsertBucket(uint64_t key, uint32_t slot);
+	void EraseBucket(size_t bucket);
+	void Rehash(size_t capacity);
+
+public:
+	template <typename SlotIterator, typename ChunkType>
+	class Iterator {
+	private:
+		SlotIterator m_Current, m_End;
+
+		void SkipEmpty() {
+			while (m_Current != m_End && !m_Current->chunk.has_value()) {
+				++m_Current;
+			}
+		}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Chunk;
+		using difference_type = std::ptrdiff_t;
+		using pointer = ChunkType*;
+		using reference = ChunkType&;
+
+		Iterator(SlotIterator current, SlotIterator end) : m_Current(current), m_End(end) { SkipEmpty(); }
+
+		reference operator*() const { return *m_Current->chunk; }
+		pointer operator->() const { return &*m_Current->chunk; }
+
+		Iterator& operator++() {
+			++m_Current;
+			SkipEmpty();
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const { return m_Current == other.m_Current; }
+		bool operator!=(const Iterator& other) const { return m_Current != other.m_Current; }
+	};
+
+	using iterator = Iterator<std::vector<Slot>::iterator, Chunk>;
+	using const_iterator = Iterator<std::vector<Slot>::const_iterator, const Chunk>;
+
+	ChunkMap();
+
+	/* Delete copying */
+	ChunkMap(const ChunkMap&) = delete;
+	ChunkMap& operator=(const ChunkMap&) = delete;
+
+	/* Allow moving */
+	ChunkMap(ChunkMap&&) noexcept = default;
+	ChunkMap& operator=(ChunkMap&&) noexcept = default;
+
+	/* Insert a chunk, replacing any chunk already stored at its position */
+	ChunkHandle Insert(Chunk&& chunk);
+
+	/* Remove the chunk at a position, returns false if it wasn't loaded */
+	bool Erase(glm::ivec2 position);
+	void Clear();
+
+	/* Lookups */
+	Chunk* Find(glm::ivec2 position);
+	const Chunk* Find(glm::ivec2 position) const;
+	inline bool Contains(glm::ivec2 position) const { return FindBucket(PackChunkKey(position)) != NOT_FOUND; }
+
+	/* Handles */
+	ChunkHandle GetHandle(glm::ivec2 position) const;
+	Chunk* Get(ChunkHandle handle);
+	const Chunk* Get(ChunkHandle handle) const;
+
+	/* Size */
+	inline size_t Size() const { return m_Count; }
+	inline bool Empty() const { return m_Count == 0; }
+
+	/* Iteration */
+	iterator begin() { return iterator(m_Slots.begin(), m_Slots.end()); }
+	iterator end() { return iterator(m_Slots.end(), m_Slots.end()); }
+	const_iterator begin() const { return const_iterator(m_Slots.begin(), m_Slots.end()); }
+	const_iterator end() const { return const_iterator(m_Slots.end(), m_Slots.end()); }
+};
+
+struct BlockEdit {
+	glm::ivec3 position;
+	BlockType type;
+};
+
+/*
+ * Loaded chunks with block access in world coordinates. Edits mark the
+ * sections they change dirty, along with the sections next to them whose
+ * faces may change: the section above or below for blocks on a section
+ * boundary, and the neighbouring chunk's section for blocks on a chunk
+ * border. Marks pile up until FlushDirty, so any number of edits between
+ * two flushes costs one rebuild per touched section.
+ */
+class World {
+private:
+	struct DirtyChunk {
+		glm::ivec2 position;
+		uint64_t sections; // Bit per section to rebuild
+	};
+
+	ChunkMap m_Chunks;
+	std::unordered_map<uint64_t, DirtyChunk> m_Dirty;
+
+	/* Change a block without looking the chunk up again, false if it's out of bounds */
+	bool SetBlock(Chunk& chunk, glm::ivec3 position, BlockType type);
+
+public:
+	World() = default;
+
+	/* Delete copying */
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	/* Chunk storage */
+	inline ChunkMap& GetChunks() { return m_Chunks; }
+	inline const ChunkMap& GetChunks() const { return m_Chunks; }
+
+	/* Blocks in unloaded chunks or outside the world's height read as air */
+	BlockType GetBlock(glm::ivec3 position) const;
+
+	/* Change a block, false if its chunk isn't loaded or it's outside the world's height */
+	bool SetBlock(glm::ivec3 position, BlockType type);
+
+	/* Change many blocks, returns how many landed in loaded chunks */
+	size_t SetBlocks(const std::vector<BlockEdit>& edits);
+
+	/* Queue sections of a chunk for rebuilding */
+	void MarkDirty(glm::ivec2 position, uint64_t sections);
+
+	/* Hand every loaded chunk with dirty sections to fn along with their bits, then forget them */
+	template <typename Fn>
+	size_t FlushDirty(Fn&& fn) {
+		size_t count = 0;
+		for (auto& [key, dirty] : m_Dirty) {
+			Chunk* chunk = m_Chunks.Find(dirty.position);
+			if (chunk != nullptr) {
+				fn(*chunk, dirty.sections);
+				count++;
+			}
+		}
+
+		m_Dirty.clear();
+		return count;
+	}
+
+	inline size_t GetDirtyCount() const { return m_Dirty.size(); }
+};
@@ -0,0 +1,495 @@
+#include "codec.h"
+
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+/* Matches shorter than this cost more than the literals they replace */
+constexpr size_t LZ_MIN_MATCH = 4;
+constexpr size_t LZ_MAX_OFFSET = 65535;
+
+/* 4096 entries keep the table in L1 */
+constexpr int LZ_HASH_BITS = 12;
+
+/* Step further ahead the longer nothing has matched, so incompressible data goes by quickly */
+constexpr int LZ_SKIP_SHIFT = 6;
+
+/* Matches closer than this are spread out before copying, see DecompressLZ */
+constexpr size_t LZ_COPY_DISTANCE = 32;
+
+/* Length continues in extra bytes once its nibble is full */
+constexpr size_t LZ_NIBBLE_MAX = 15;
+
+static uint32_t Read32(const unsigned char* bytes) {
+	uint32_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static uint64_t Read64(const unsigned char* bytes) {
+	uint64_t value;
+	std::memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+static uint32_t HashPrefix(uint32_t prefix) {
+	return (prefix * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* Bytes from a that equal those from b, a being ahead of b and reading no further than end */
+static size_t GetMatchLength(const unsigned char* a, const unsigned char* b, const unsigned char* end) {
+	const unsigned char* begin = a;
+	while (a + 8 <= end && Read64(a) == Read64(b)) {
+		a += 8;
+		b += 8;
+	}
+
+	while (a < end && *a == *b) {
+		a++;
+		b++;
+	}
+
+	return static_cast<size_t>(a - begin);
+}
+
+static unsigned char* WriteLength(unsigned char* op, size_t length) {
+	while (length >= 255) {
+		*op++ = 255;
+		length -= 255;
+	}
+
+	*op++ = static_cast<unsigned char>(length);
+	return op;
+}
+
+/* Zero match length writes the final, literals only sequence */
+static unsigned char* WriteSequence(unsigned char* op, const unsigned char* literals, size_t count, size_t offset, size_t match) {
+	unsigned char* token = op++;
+	if (count >= LZ_NIBBLE_MAX) {
+		op = WriteLength(op, count - LZ_NIBBLE_MAX);
+	}
+
+	if (count != 0) {
+		std::memcpy(op, literals, count);
+		op += count;
+	}
+
+	const size_t literal_code = std::min(count, LZ_NIBBLE_MAX);
+	if (match == 0) {
+		*token = static_cast<unsigned char>(literal_code << 4);
+		return op;
+	}
+
+	*op++ = static_cast<unsigned char>(offset);
+	*op++ = static_cast<unsigned char>(offset >> 8);
+
+	const size_t match_code = std::min(match - LZ_MIN_MATCH, LZ_NIBBLE_MAX);
+	if (match_code == LZ_NIBBLE_MAX) {
+		op = WriteLength(op, match - LZ_MIN_MATCH - LZ_NIBBLE_MAX);
+	}
+
+	*token = static_cast<unsigned char>(literal_code << 4 | match_code);
+	return op;
+}
+
+/* Adds the extra bytes of a length whose nibble was full, false if the stream ends first */
+static bool ReadLength(const unsigned char*& ip, const unsigned char* end, size_t& length) {
+	unsigned char byte;
+	do {
+		if (ip == end) {
+			return false;
+		}
+
+		byte = *ip++;
+		length += byte;
+	} while (byte == 255);
+
+	return true;
+}
+
+void CompressLZ(const unsigned char* data, size_t size, std::vector<unsigned char>& out) {
+	/* Worst case, everything is literals */
+	const size_t start = out.size();
+	out.resize(start + size + size / 255 + 16);
+	unsigned char* op = out.data() + start;
+
+	/* Positions of the last 4 byte prefix with each hash, 32 bit so inputs stay under 4 GB, a candidate is verified before it's used */
+	uint32_t table[1 << LZ_HASH_BITS] = {};
+
+	size_t anchor = 0;
+	size_t ip = 0;
+	while (ip + LZ_MIN_MATCH <= size) {
+		const uint32_t prefix = Read32(data + ip);
+		uint32_t& slot = table[HashPrefix(prefix)];
+		size_t candidate = slot;
+		slot = static_cast<uint32_t>(ip);
+
+		if (candidate >= ip || ip - candidate > LZ_MAX_OFFSET || Read32(data + candidate) != prefix) {
+			ip += 1 + ((ip - anchor) >> LZ_SKIP_SHIFT);
+			continue;
+		}
+
+		/* The match may start before the prefix that found it */
+		while (ip > anchor && candidate > 0 && data[ip - 1] == data[candidate - 1]) {
+			ip--;
+			candidate--;
+		}
+
+		const size_t length = LZ_MIN_MATCH + GetMatchLength(data + ip + LZ_MIN_MATCH, data + candidate + LZ_MIN_MATCH, data + size);
+		op = WriteSequence(op, data + anchor, ip - anchor, ip - candidate, length);
+		ip += length;
+		anchor = ip;
+
+		/* Catch a match starting right where this one ended */
+		if (ip + LZ_MIN_MATCH <= size + 2) {
+			table[HashPrefix(Read32(data + ip - 2))] = static_cast<uint32_t>(ip - 2);
+		}
+	}
+
+	op = WriteSequence(op, data + anchor, size - anchor, 0, 0);
+	out.resize(static_cast<size_t>(op - out.data()));
+}
+
+bool DecompressLZ(const unsigned char* data, size_t size, unsigned char* out, size_t out_size) {
+	const unsigned char* ip = data;
+	const unsigned char* const iend = data + size;
+	unsigned char* op = out;
+	unsigned char* const oend = out + out_size;
+
+	for (;;) {
+		if (ip == iend) {
+			return false;
+		}
+
+		const unsigned char token = *ip++;
+
+		/* Short literal runs are copied 16 bytes at once, whatever is past the run is overwritten later */
+		size_t literals = token >> 4;
+		if (literals == LZ_NIBBLE_MAX && !ReadLength(ip, iend, literals)) {
+			return false;
+		}
+
+		if (literals > static_cast<size_t>(iend - ip) || literals > static_cast<size_t>(oend - op)) {
+			return false;
+		}
+
+		if (literals <= 16 && ip + 16 <= iend && op + 16 <= oend) {
+			std::memcpy(op, ip, 16);
+		} else if (literals != 0) {
+			std::memcpy(op, ip, literals);
+		}
+
+		ip += literals;
+		op += literals;
+
+		/* The last sequence has no match */
+		if (ip == iend) {
+			break;
+		}
+
+		if (iend - ip < 2) {
+			return false;
+		}
+
+		const size_t offset = static_cast<size_t>(ip[0]) | static_cast<size_t>(ip[1]) << 8;
+		ip += 2;
+
+		size_t length = (token & LZ_NIBBLE_MAX) + LZ_MIN_MATCH;
+		if ((token & LZ_NIBBLE_MAX) == LZ_NIBBLE_MAX && !ReadLength(ip, iend, length)) {
+			return false;
+		}
+
+		if (offset == 0 || offset > static_cast<size_t>(op - out) || length > static_cast<size_t>(oend - op)) {
+			return false;
+		}
+
+		const unsigned char* match = op - offset;
+		unsigned char* const end = op + length;
+
+		/*
+		 * Close matches overlap what they write. Doubling the copied pattern
+		 * until the source trails by at least LZ_COPY_DISTANCE bytes, always a
+		 * multiple of the offset since the output repeats with that period,
+		 * lets the rest go 16 bytes at a time without a copy reading bytes
+		 * the one before it has only just stored.
+		 */
+		if (offset < LZ_COPY_DISTANCE) {
+			size_t period = offset;
+			while (period < LZ_COPY_DISTANCE && op + period <= end) {
+				std::memcpy(op, op - period, period);
+				op += period;
+				period *= 2;
+			}
+
+			match = op - period;
+			if (period < LZ_COPY_DISTANCE) {
+				match = op - offset;
+				while (op < end) {
+					*op++ = *match++;
+				}
+			}
+		}
+
+		/* Matches ending near the end of the output can't copy past themselves, only their tail goes byte by byte */
+		if (end + 16 <= oend) {
+			while (op < end) {
+				std::memcpy(op, match, 16);
+				op += 16;
+				match += 16;
+			}
+		} else {
+			while (op + 16 <= end) {
+				std::memcpy(op, match, 16);
+				op += 16;
+				match += 16;
+			}
+
+			while (op < end) {
+				*op++ = *match++;
+			}
+		}
+
+		op = end;
+	}
+
+	return op == oend;
+}
+
+static void WriteVarint(std::vector<unsigned char>& out, size_t value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<unsigned char>(value | 0x80));
+		value >>= 7;
+	}
+
+	out.push_back(static_cast<unsigned char>(value));
+}
+
+static bool ReadVarint(const unsigned char*& ip, const unsigned char* end, size_t& value) {
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (ip == end) {
+			return false;
+		}
+
+		const unsigned char byte = *ip++;
+		value |= static_cast<size_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* How CompressBlocks laid out a chunk, its first byte */
+constexpr unsigned char BLOCKS_RUNS = 0; // Palette and layer runs
+constexpr unsigned char BLOCKS_RAW = 1;  // The block bytes as they are, when runs would only make them bigger
+
+/* Longest run a pair can hold, longer ones are split and the LZ stage folds the pieces together */
+constexpr size_t BLOCKS_MAX_RUN = 256;
+
+/* Fill writes whole 16 byte blocks, so the destination needs this much room past the end */
+constexpr size_t BLOCKS_FILL_SLACK = 16;
+
+static void AddRun(std::vector<unsigned char>& runs, unsigned char index, size_t length) {
+	while (length > BLOCKS_MAX_RUN) {
+		runs.push_back(index);
+		runs.push_back(static_cast<unsigned char>(BLOCKS_MAX_RUN - 1));
+		length -= BLOCKS_MAX_RUN;
+	}
+
+	runs.push_back(index);
+	runs.push_back(static_cast<unsigned char>(length - 1));
+}
+
+/* Write value over at least count bytes, 16 at a time */
+static void FillRun(unsigned char* out, unsigned char value, size_t count) {
+	const uint64_t pattern = value * 0x0101010101010101ull;
+	unsigned char* const end = out + count;
+	do {
+		std::memcpy(out, &pattern, 8);
+		std::memcpy(out + 8, &pattern, 8);
+		out += 16;
+	} while (out < end);
+}
+
+/*
+ * Blocks start with the layout and the block count as a varint. The runs
+ * layout goes on with the palette size minus one and the palette, then,
+ * unless the palette has a single entry, the size of the run stream as a
+ * varint and the run stream through CompressLZ. Each run is a palette index
+ * and its length minus one, one byte each.
+ *
+ * Runs go through the chunk a layer at a time, bottom to top, each layer in
+ * rows along x. A layer of one block is a single run, and so is a stack of
+ * them, however thick. Decompressing fills the runs into a buffer in that
+ * order and moves each row into place with one copy.
+ */
+void CompressBlocks(const BlockType* blocks, int width, int height, int depth, std::vector<unsigned char>& out) {
+	const size_t volume = static_cast<size_t>(width) * height * depth;
+
+	/* Palette in order of first appearance */
+	int indices[256];
+	std::fill(std::begin(indices), std::end(indices), -1);
+	std::vector<unsigned char> palette;
+
+	std::vector<unsigned char> runs;
+	int current = -1;
+	size_t length = 0;
+	for (int y = 0; y < height; y++) {
+		for (int z = 0; z < depth; z++) {
+			const BlockType* row = blocks + static_cast<size_t>(y) * width + static_cast<size_t>(z) * width * height;
+			for (int x = 0; x < width; x++) {
+				const unsigned char block = static_cast<unsigned char>(row[x]);
+				if (indices[block] == -1) {
+					indices[block] = static_cast<int>(palette.size());
+					palette.push_back(block);
+				}
+
+				if (indices[block] == current) {
+					length++;
+					continue;
+				}
+
+				if (length != 0) {
+					AddRun(runs, static_cast<unsigned char>(current), length);
+				}
+
+				current = indices[block];
+				length = 1;
+			}
+		}
+	}
+
+	if (length != 0) {
+		AddRun(runs, static_cast<unsigned char>(current), length);
+	}
+
+	/* Noise has runs of one or two blocks, storing it as it is comes out smaller */
+	if (runs.size() >= volume) {
+		out.push_back(BLOCKS_RAW);
+		WriteVarint(out, volume);
+		CompressLZ(reinterpret_cast<const unsigned char*>(blocks), volume, out);
+		return;
+	}
+
+	if (palette.empty()) {
+		palette.push_back(static_cast<unsigned char>(BlockType::AIR));
+	}
+
+	out.push_back(BLOCKS_RUNS);
+	WriteVarint(out, volume);
+	out.push_back(static_cast<unsigned char>(palette.size() - 1));
+	out.insert(out.end(), palette.begin(), palette.end());
+
+	if (palette.size() == 1) {
+		return;
+	}
+
+	WriteVarint(out, runs.size());
+	CompressLZ(runs.data(), runs.size(), out);
+}
+
+bool DecompressBlocks(const unsigned char* data, size_t size, int width, int height, int depth, BlockType* blocks) {
+	const unsigned char* ip = data;
+	const unsigned char* const iend = data + size;
+	const size_t volume = static_cast<size_t>(width) * height * depth;
+
+	if (ip == iend) {
+		return false;
+	}
+
+	/* Checked up front, a chunk of a single block has nothing else to tell its size by */
+	const unsigned char layout = *ip++;
+	size_t count;
+	if (!ReadVarint(ip, iend, count) || count != volume) {
+		return false;
+	}
+
+	if (layout == BLOCKS_RAW) {
+		unsigned char* bytes = reinterpret_cast<unsigned char*>(blocks);
+		if (!DecompressLZ(ip, static_cast<size_t>(iend - ip), bytes, volume)) {
+			return false;
+		}
+
+		return std::all_of(bytes, bytes + volume, [](unsigned char block) { return block < BLOCK_TYPE_COUNT; });
+	}
+
+	if (layout != BLOCKS_RUNS || ip == iend) {
+		return false;
+	}
+
+	const size_t palette_size = static_cast<size_t>(*ip++) + 1;
+	if (palette_size > static_cast<size_t>(iend - ip)) {
+		return false;
+	}
+
+	unsigned char palette[256];
+	for (size_t i = 0; i < palette_size; i++) {
+		if (ip[i] >= BLOCK_TYPE_COUNT) {
+			return false;
+		}
+
+		palette[i] = ip[i];
+	}
+
+	ip += palette_size;
+
+	if (palette_size == 1) {
+		std::fill(blocks, blocks + volume, static_cast<BlockType>(palette[0]));
+		return ip == iend;
+	}
+
+	/* Every run covers at least one block */
+	size_t runs_size;
+	if (!ReadVarint(ip, iend, runs_size) || runs_size % 2 != 0 || runs_size / 2 > volume) {
+		return false;
+	}
+
+	/* Runs followed by the layers they fill */
+	std::unique_ptr<unsigned char[]> buffer(new unsigned char[runs_size + volume + BLOCKS_FILL_SLACK]);
+	unsigned char* const runs = buffer.get();
+	unsigned char* const layers = runs + runs_size;
+
+	if (!DecompressLZ(ip, static_cast<size_t>(iend - ip), runs, runs_size)) {
+		return false;
+	}
+
+	size_t filled = 0;
+	for (size_t i = 0; i < runs_size; i += 2) {
+		const size_t length = static_cast<size_t>(runs[i + 1]) + 1;
+		if (runs[i] >= palette_size || length > volume - filled) {
+			return false;
+		}
+
+		FillRun(layers + filled, palette[runs[i]], length);
+		filled += length;
+	}
+
+	if (filled != volume) {
+		return false;
+	}
+
+	/* Rows back to the constructor's layout, a constant size copy for the usual 16 wide chunk */
+	const unsigned char* row = layers;
+	if (width == 16) {
+		for (int y = 0; y < height; y++) {
+			for (int z = 0; z < depth; z++) {
+				std::memcpy(blocks + static_cast<size_t>(y) * 16 + static_cast<size_t>(z) * 16 * height, row, 16);
+				row += 16;
+			}
+		}
+
+		return true;
+	}
+
+	for (int y = 0; y < height; y++) {
+		for (int z = 0; z < depth; z++) {
+			std::memcpy(blocks + static_cast<size_t>(y) * width + static_cast<size_t>(z) * width * height, row, width);
+			row += width;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "blocks.h"
+
+/*
+ * LZ77 byte compression in the style of LZ4. The stream is a series of
+ * sequences, each a token byte holding the literal count in its high nibble
+ * and the match length minus 4 in its low nibble, either of which continues
+ * in extra bytes when it's 15, followed by the literals, a 16 bit little
+ * endian offset back into the output and any extra match length bytes. The
+ * last sequence is literals only. Matches are found through a single hash
+ * table of 4 byte prefixes, so compressing is one pass and decompressing is
+ * nothing but copies. Nothing is stored about the uncompressed size, the
+ * caller keeps it.
+ */
+void CompressLZ(const unsigned char* data, size_t size, std::vector<unsigned char>& out);
+
+/* Out must hold exactly out_size bytes, false if the stream is damaged or decompresses to any other size */
+bool DecompressLZ(const unsigned char* data, size_t size, unsigned char* out, size_t out_size);
+
+/*
+ * Chunk blocks in the layout the Chunk constructor takes. Blocks are turned
+ * into indices into a palette of the block types in the chunk and read a
+ * layer at a time, bottom to top, as runs of one index, so a layer of one
+ * block (bedrock, stone, the air above the ground) is a single run however
+ * thick it is. Runs that repeat from row to row are reduced to short matches
+ * by the LZ stage. Chunks so noisy that runs wouldn't pay off are stored as
+ * they are through the LZ stage alone.
+ */
+void CompressBlocks(const BlockType* blocks, int width, int height, int depth, std::vector<unsigned char>& out);
+
+/* Blocks must hold width * height * depth entries, false if the data is damaged or holds a different size */
+bool DecompressBlocks(const unsigned char* data, size_t size, int width, int height, int depth, BlockType* blocks);
@@ -0,0 +1,82 @@
+#include "frustum.h"
+
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define FRUSTUM_SSE
+#include <xmmintrin.h>
+#endif
+
+Frustum::Frustum(const glm::mat4& viewProjection) {
+	/* glm is column major, row i is m[0][i], m[1][i], m[2][i], m[3][i] */
+	auto row = [&](int i) {
+		return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+	};
+
+	/* Gribb-Hartmann extraction, the plane test only needs signs so they stay unnormalized */
+	const glm::vec4 planes[6] = {
+		row(3) + row(0), // Left
+		row(3) - row(0), // Right
+		row(3) + row(1), // Bottom
+		row(3) - row(1), // Top
+		row(3) + row(2), // Near
+		row(3) - row(2), // Far
+	};
+
+	for (int i = 0; i < 8; i++) {
+		/* Padding planes accept everything */
+		glm::vec4 plane = i < 6 ? planes[i] : glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		m_X[i] = plane.x;
+		m_Y[i] = plane.y;
+		m_Z[i] = plane.z;
+		m_W[i] = plane.w;
+	}
+}
+
+bool Frustum::IsBoxVisible(const AABB& box) const {
+	const glm::vec3 center = (box.min + box.max) * 0.5f;
+	const glm::vec3 extent = (box.max - box.min) * 0.5f;
+
+	/*
+	 * Signed distance of the center plus the box's projected radius on the
+	 * plane normal, negative means every corner is behind the plane.
+	 */
+#ifdef FRUSTUM_SSE
+	const __m128 signMask = _mm_set1_ps(-0.0f);
+	const __m128 cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+	const __m128 ex = _mm_set1_ps(extent.x), ey = _mm_set1_ps(extent.y), ez = _mm_set1_ps(extent.z);
+
+	for (int i = 0; i < 8; i += 4) {
+		__m128 nx = _mm_load_ps(m_X + i);
+		__m128 ny = _mm_load_ps(m_Y + i);
+		__m128 nz = _mm_load_ps(m_Z + i);
+
+		__m128 distance = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+			_mm_add_ps(_mm_mul_ps(nz, cz), _mm_load_ps(m_W + i))
+		);
+
+		__m128 radius = _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, nx), ex), _mm_mul_ps(_mm_andnot_ps(signMask, ny), ey)),
+			_mm_mul_ps(_mm_andnot_ps(signMask, nz), ez)
+		);
+
+		if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps())) != 0) {
+			return false;
+		}
+	}
+
+	return true;
+#else
+	for (int i = 0; i < 6; i++) {
+		float distance = m_X[i] * center.x + m_Y[i] * center.y + m_Z[i] * center.z + m_W[i];
+		float radius = std::fabs(m_X[i]) * extent.x + std::fabs(m_Y[i]) * extent.y + std::fabs(m_Z[i]) * extent.z;
+
+		if (distance + radius < 0.0f) {
+			return false;
+		}
+	}
+
+	return true;
+#endif
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glm/glm.hpp>
+
+struct AABB {
+	glm::vec3 min;
+	glm::vec3 max;
+};
+
+struct CullStats {
+	size_t visible = 0;
+	size_t culled = 0;
+};
+
+/*
+ * View frustum planes taken from a projection * view matrix. Planes are kept
+ * as separate x, y, z and w arrays padded to eight entries, so the box test
+ * checks four planes per SSE instruction. Planes point inwards; a box is
+ * culled once it lies fully behind any of them.
+ */
+class Frustum {
+private:
+	alignas(16) float m_X[8];
+	alignas(16) float m_Y[8];
+	alignas(16) float m_Z[8];
+	alignas(16) float m_W[8];
+
+public:
+	Frustum(const glm::mat4& viewProjection);
+
+	/* Conservative, boxes near a frustum corner may pass while outside */
+	bool IsBoxVisible(const AABB& box) const;
+};
@@ -1,16 +1,10 @@
 #include "generation.h"
 
 #include <iostream>
-#include <unordered_map>
 
 std::vector<BlockType> FlatWorldGenerator(glm::ivec2 chunk, int width, int height, int depth) {
-    static std::vector<BlockType> blocks(width * height * depth, BlockType::AIR);
-
-    /* Only generate once  */
-    static bool cached = false;
-    if (cached) {
-        return blocks;
-    }
+    /* Generated per call, workers may run this concurrently */
+    std::vector<BlockType> blocks(width * height * depth, BlockType::AIR);
 
     for (int x = 0; x < width; x++) {
         for (int y = 0; y < height; y++) {
@@ -28,32 +22,25 @@ std::vector<BlockType> FlatWorldGenerator(glm::ivec2 chunk, int width, int heigh
         }
     }
 
-    cached = true;
     return blocks;
 }
 
 std::vector<BlockType> BlockTestWorldGenerator(glm::ivec2 chunk, int width, int height, int depth) {
-    static std::unordered_map<BlockType, std::vector<BlockType>> block_map;
-
-    /* Create block type */
-    BlockType block = static_cast<BlockType>((static_cast<int>(BlockType::BEDROCK) * 1000 + chunk.x + chunk.y) % (static_cast<int>(BlockType::BEDROCK) + 1) + 1);
+    /* Create block type, anything but air */
+    BlockType block = static_cast<BlockType>((static_cast<int>(BlockType::BEDROCK) * 1000 + chunk.x + chunk.y) % static_cast<int>(BlockType::BEDROCK) + 1);
 
-    /* Cache the value */
-    if (!block_map.count(block)) {
-        std::vector<BlockType> blocks(width * height * depth, BlockType::AIR);
+    /* Generated per call, workers may run this concurrently */
+    std::vector<BlockType> blocks(width * height * depth, BlockType::AIR);
 
-        for (int x = 2; x < width - 2; x++) {
-            for (int y = 0; y < 5; y++) {
-                for (int z = 2; z < depth - 2; z++) {
-                    blocks[GetBlockIndex(x, y, z, width, height, depth)] = block;
-                }
+    for (int x = 2; x < width - 2; x++) {
+        for (int y = 0; y < 5; y++) {
+            for (int z = 2; z < depth - 2; z++) {
+                blocks[GetBlockIndex(x, y, z, width, height, depth)] = block;
             }
         }
-
-        block_map[block] = std::move(blocks);
     }
 
-    return block_map[block];
+    return blocks;
 }
 
 LuaWorldGenerator::LuaWorldGenerator(const std::filesystem::path& path) {
@@ -62,7 +49,7 @@ LuaWorldGenerator::LuaWorldGenerator(const std::filesystem::path& path) {
 
     /* Register blocks */
     lua_newtable(L);
-    for (int i = 0; i < static_cast<int>(BlockType::BEDROCK); i++) {
+    for (int i = 0; i < BLOCK_TYPE_COUNT; i++) {
         lua_pushnumber(L, i);
         lua_pushstring(L, BlockTypeToString(static_cast<BlockType>(i)));
         lua_settable(L, -3);
@@ -101,7 +88,7 @@ LuaWorldGenerator& LuaWorldGenerator::operator=(LuaWorldGenerator&& other) noexc
 }
 
 std::vector<BlockType> LuaWorldGenerator::GetChunk(glm::ivec2 chunk, int width, int height, int depth) {
-    static std::vector<BlockType> defaultChunk(width * height * depth, BlockType::AIR);
+    std::vector<BlockType> defaultChunk(width * height * depth, BlockType::AIR);
 
     /* Return void if lua was moved */
     if (L == nullptr) {
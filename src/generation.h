@@ -8,12 +8,13 @@ extern "C" {
 
 #include "world.h"
 
-/* Flat world generation function */
+/* Flat world generation function, safe to call from worker threads */
 std::vector<BlockType> FlatWorldGenerator(glm::ivec2 chunk, int width, int height, int depth);
 
-/* Block test generation */
+/* Block test generation, safe to call from worker threads */
 std::vector<BlockType> BlockTestWorldGenerator(glm::ivec2 chunk, int width, int height, int depth);
 
+/* Owns a single Lua state, so it must only be called from one thread at a time */
 class LuaWorldGenerator {
 private:
     lua_State* L;
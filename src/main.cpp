@@ -1,8 +1,8 @@
 #include <iostream>
 #include <filesystem>
 #include <algorithm>
-#include <set>
 #include <vector>
+#include <string>
 
 /* OpenGL */
 #include <glad/glad.h>
@@ -21,10 +21,21 @@
 #include "renderer/shaders.h"
 #include "renderer/textures.h"
 #include "renderer/models.h"
+#include "renderer/arena.h"
+#include "renderer/extensions.h"
+#include "renderer/state.h"
+#include "renderer/readback.h"
 
 #include "camera.h"
 #include "world.h"
+#include "chunks.h"
+#include "meshing.h"
 #include "generation.h"
+#include "workers.h"
+#include "streaming.h"
+#include "region.h"
+#include "frustum.h"
+#include "raycast.h"
 
 #define WIDTH 960
 #define HEIGHT 540
@@ -32,8 +43,22 @@
 constexpr int CHUNK_SIZE = 16;
 constexpr int CHUNK_HEIGHT = 16;
 constexpr int RENDER_DISTANCE = 10;
+constexpr int UNLOAD_DISTANCE = 12;
 
-constexpr WorldSettings settings = { CHUNK_SIZE, CHUNK_HEIGHT, CHUNK_SIZE, RENDER_DISTANCE };
+constexpr WorldSettings settings = { CHUNK_SIZE, CHUNK_HEIGHT, CHUNK_SIZE, RENDER_DISTANCE, UNLOAD_DISTANCE };
+
+/* Memory for unloaded chunks kept around in case they come back, and whether their CPU meshes are kept too */
+constexpr size_t CHUNK_CACHE_SIZE = 64 << 20;
+constexpr bool CHUNK_CACHE_MESHES = false;
+
+/* Chunk mesh bytes and milliseconds spent uploading per frame, the rest wait for the next one */
+constexpr UploadBudget upload_budget = { 1 << 20, 2.0f };
+
+/* Meshing */
+MeshingMode meshing_mode = MeshingMode::BINARY_GREEDY;
+
+/* Screenshots, captured at the end of the frame the key was pressed in */
+bool screenshot_requested = false;
 
 /* Crosshair */
 constexpr int CROSSHAIR_SIZE = 16;
@@ -44,6 +69,8 @@ const std::filesystem::path assets_path = std::filesystem::current_path() / "ass
 const std::filesystem::path shaders_path = assets_path / "shaders";
 const std::filesystem::path textures_path = assets_path / "textures";
 const std::filesystem::path scripts_path = assets_path / "scripts";
+const std::filesystem::path screenshots_path = std::filesystem::current_path() / "screenshots";
+const std::filesystem::path saves_path = std::filesystem::current_path() / "world";
 
 struct UIElementVertex {
     glm::vec2 position;
@@ -76,7 +103,7 @@ const unsigned int crosshair_indices[] = {
     2, 3, 0
 };
 
-void parseInputs(GLFWwindow* window, std::vector<std::tuple<glm::ivec2, Chunk>>& chunks, Camera& camera, float deltaTime) {
+void parseInputs(GLFWwindow* window, World& world, Camera& camera, float deltaTime) {
 	float cameraSpeed = 0.025f * deltaTime;
 
     glm::vec3 front = glm::normalize(camera.GetFront() * glm::vec3(1.0f, 0.0f, 1.0f));
@@ -97,6 +124,24 @@ void parseInputs(GLFWwindow* window, std::vector<std::tuple<glm::ivec2, Chunk>>&
         held = false;
     }
 
+    /* Switch meshing mode */
+    static bool meshing_held;
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !meshing_held) {
+        meshing_held = true;
+        meshing_mode = static_cast<MeshingMode>((static_cast<int>(meshing_mode) + 1) % (static_cast<int>(MeshingMode::BINARY_GREEDY) + 1));
+    } else if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE) {
+        meshing_held = false;
+    }
+
+    /* Take a screenshot */
+    static bool screenshot_held;
+    if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_PRESS && !screenshot_held) {
+        screenshot_held = true;
+        screenshot_requested = true;
+    } else if (glfwGetKey(window, GLFW_KEY_F2) == GLFW_RELEASE) {
+        screenshot_held = false;
+    }
+
     /* Add to camera speed */
     if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
         cameraSpeed *= 2.0f;
@@ -127,23 +172,40 @@ void parseInputs(GLFWwindow* window, std::vector<std::tuple<glm::ivec2, Chunk>>&
 		camera.SetPosition(camera.GetPosition() - glm::vec3(0.0f, cameraSpeed, 0.0f));
 	}
 
-    /* Check if left click pressed */
+    /* Break the block under the crosshair */
     static bool left_click = false;
     if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS && !left_click) {
         left_click = true;
 
         /* Calculate raycast */
         RaycastResult result;
-        if (Raycast(settings, chunks, camera.GetPosition(), camera.GetFront(), 15.0f, result)) {
+        if (Raycast(settings, world.GetChunks(), camera.GetPosition(), camera.GetFront(), 15.0f, result)) {
             std::cout 
-                << "Raycast hit: " << static_cast<int>(result.position.x) << ", " << static_cast<int>(result.position.y) << ", " << static_cast<int>(result.position.z) 
+                << "Raycast hit: " << result.block.x << ", " << result.block.y << ", " << result.block.z 
                 << " = " << BlockTypeToString(result.type)
+                << ", face " << result.normal.x << ", " << result.normal.y << ", " << result.normal.z
+                << ", place at " << result.placement.x << ", " << result.placement.y << ", " << result.placement.z
                 << std::endl;
+
+            world.SetBlock(result.block, BlockType::AIR);
         }
     } else if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_RELEASE) {
         left_click = false;
     }
 
+    /* Place a block against the face under the crosshair */
+    static bool right_click = false;
+    if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS && !right_click) {
+        right_click = true;
+
+        RaycastResult result;
+        if (Raycast(settings, world.GetChunks(), camera.GetPosition(), camera.GetFront(), 15.0f, result) && result.normal != glm::ivec3(0)) {
+            world.SetBlock(result.placement, BlockType::COBBLESTONE);
+        }
+    } else if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_RELEASE) {
+        right_click = false;
+    }
+
     /* Set rotation */
     const float sensitivity = 0.05f;
 	static double last_x = WIDTH / 2.0;
@@ -183,58 +245,25 @@ void glfwCallback(int error, const char* description) {
     std::cerr << "GLFW Error: " << description << std::endl;
 }
 
-void updateChunks(ChunkGeneratorFn generator, std::shared_ptr<render::Texture> terrain, std::vector<std::tuple<glm::ivec2, Chunk>>& chunks, glm::vec3 player_position) {    
-    /* Calculate chunk position */
-    glm::ivec2 player_chunk = glm::ivec2(player_position.x, player_position.z) / 16;
- 
-    /* Add meshes that are needed */
-    std::set<std::pair<int, int>> keep_alive;
-    for (int offset_x = -RENDER_DISTANCE; offset_x < RENDER_DISTANCE; offset_x++) {
-        for (int offset_z = -RENDER_DISTANCE; offset_z < RENDER_DISTANCE; offset_z++) {
-            /* Calculate chunk position and distance */
-            glm::ivec2 chunk = player_chunk + glm::ivec2(offset_x, offset_z);
-
-            /* Skip if distance is too long */
-            float distance = glm::sqrt(static_cast<double>(offset_x * offset_x + offset_z * offset_z));
-            if (distance < RENDER_DISTANCE) {
-                keep_alive.insert({ chunk.x, chunk.y });
-            }
-        }
-    }
-
-    /* Render new chunks */
-    for (const auto& to_render : keep_alive) {
-        /* Check if chunk is already in chunks list */
-        bool is_cached = false;
-        for (const auto& alive_chunk : chunks) {
-            const auto& [position, _] = alive_chunk;
-
-            if (to_render.first == position.x && to_render.second == position.y) {
-                is_cached = true;
-                break;
-            }
-        }
+void reportMeshStats(const ChunkMap& chunks) {
+    MeshStats total;
 
-        /* If chunk isn't cached, render */
-        if (!is_cached) {
-            glm::ivec2 chunk_postion = glm::ivec2(to_render.first, to_render.second);
+    for (const Chunk& chunk : chunks) {
+        MeshStats stats = chunk.GetMeshStats();
 
-            auto blocks = generator(chunk_postion, CHUNK_SIZE, CHUNK_HEIGHT, CHUNK_SIZE);
-            auto mesh = CreateChunkMesh(terrain, blocks, chunk_postion, CHUNK_SIZE, CHUNK_HEIGHT, CHUNK_SIZE);
-            auto chunk = Chunk(chunk_postion, blocks, std::move(mesh));
-
-            chunks.push_back(std::make_tuple(chunk_postion, std::move(chunk)));
-        }
+        total.faces += stats.faces;
+        total.quads += stats.quads;
+        total.vertices += stats.vertices;
+        total.indices += stats.indices;
     }
 
-    /* Remove any chunks that shouldn't be alive */
-    for (auto it = chunks.begin(); it != chunks.end(); it++) {
-        const auto& [position, _] = *it;
-
-        if (keep_alive.find({ position.x, position.y }) == keep_alive.end()) {
-            chunks.erase(it);            
-        }
-    }
+    /* Report how much the current mode saves over one quad per face */
+    float reduction = total.faces > 0 ? 100.0f * (1.0f - static_cast<float>(total.quads) / total.faces) : 0.0f;
+    std::cout
+        << "Meshing mode: " << MeshingModeToString(meshing_mode) << " - "
+        << total.vertices << " vertices, " << total.indices << " indices, "
+        << total.quads << "/" << total.faces << " quads (" << reduction << "% fewer)"
+        << std::endl;
 }
 
 int main(int argc, char* argv[]) {
@@ -276,6 +305,9 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
+    /* Load entry points newer than glad's */
+    render::LoadExtensions((GLADloadproc)glfwGetProcAddress);
+
     /* Print OpenGL version */
     std::cout << "Working directory: " << std::filesystem::current_path() << std::endl;
     std::cout << "OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
@@ -304,19 +336,46 @@ int main(int argc, char* argv[]) {
     /* Create shader program */
     ShaderProgram world_program(world_collection);
 
-    /* Create texture */
-    std::shared_ptr<Texture> terrain = std::make_shared<Texture>(textures_path / "terrain.png");
+    /* Upload tint palette */
+    glm::vec3 tints[BLOCK_TINT_COUNT];
+    for (int i = 0; i < BLOCK_TINT_COUNT; i++) {
+        tints[i] = GetTintColor(static_cast<BlockTint>(i));
+    }
+
+    world_program.GetUniform<glm::vec3>("u_Tints").Set(tints, BLOCK_TINT_COUNT);
+
+    /* Camera data shared by every program */
+    UniformBuffer camera_buffer(sizeof(CameraUniforms));
+    camera_buffer.BindBase(CAMERA_UNIFORM_BINDING);
+
+    /* Block textures, one atlas tile per layer */
+    TextureArray terrain(textures_path / "terrain.png", ATLAS_TILE_COUNT, ATLAS_TILE_COUNT);
 
     /* Camera */
     Camera camera(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
 
     /* Set texture parameters */
-    terrain->GenerateMipmaps();
-    terrain->SetWrapMode(WrapMode::CLAMP_TO_EDGE);
-    terrain->SetFilterMode(FilterMode::NEAREST_MIPMAP_LINEAR, FilterMode::NEAREST);
+    terrain.GenerateMipmaps();
+    terrain.SetWrapMode(WrapMode::REPEAT);
+    terrain.SetFilterMode(FilterMode::NEAREST_MIPMAP_LINEAR, FilterMode::NEAREST);
+
+    /* Chunk geometry, must outlive the chunks holding allocations in it */
+    GeometryArena world_arena(GetChunkVertexLayout(), GetChunkInstanceLayout(), 1 << 20, 3 << 19);
+
+    /* Loaded chunks and block edits */
+    World world;
+    ChunkMap& chunks = world.GetChunks();
+
+    /* Chunks explored so far, read back by the workers, must outlive them */
+    ChunkStorage storage(saves_path, settings);
 
-    /* Chunk array */
-    std::vector<std::tuple<glm::ivec2, Chunk>> chunks;
+    /* Chunk generation and meshing workers */
+    ChunkWorkerPool workers(BlockTestWorldGenerator, settings, 0, &storage);
+    std::cout << "Chunk workers: " << workers.GetThreadCount() << std::endl;
+
+    /* Loads chunks around the player nearest first and unloads the ones left behind */
+    ChunkCache chunk_cache(CHUNK_CACHE_SIZE, CHUNK_CACHE_MESHES);
+    ChunkStreamer streamer(world, workers, world_arena, chunk_cache, &storage, settings, upload_budget);
 
     /* Chunks generator */    
     LuaWorldGenerator generator(scripts_path / "world.lua");
@@ -324,9 +383,6 @@ int main(int argc, char* argv[]) {
         return generator.GetChunk(chunk, width, height, depth);
     };
 
-    /* Crosshair */
-    unsigned char crosshair[CROSSHAIR_SIZE * CROSSHAIR_SIZE * 4];
-    
     /* Crosshair stencil */
     std::shared_ptr<Texture> crosshair_stencil = std::make_shared<Texture>(textures_path / "crosshair.png");
     crosshair_stencil->SetWrapMode(WrapMode::CLAMP_TO_EDGE);
@@ -349,7 +405,7 @@ int main(int argc, char* argv[]) {
     Mesh crosshair_mesh(
         crosshair_layout, 
         crosshair_vertices, sizeof(crosshair_vertices),
-        crosshair_indices, sizeof(crosshair_indices) / sizeof(unsigned int), {}
+        crosshair_indices, sizeof(crosshair_indices) / sizeof(unsigned int), { crosshair_stencil }
     );
 
     /* Main loop */
@@ -357,74 +413,155 @@ int main(int argc, char* argv[]) {
     std::chrono::time_point<std::chrono::high_resolution_clock> current_time;
     float delta_time = 0.0;
 
+    /* Framebuffer reads finish a frame or two later, PNGs are encoded off the render thread */
+    ReadbackQueue readback;
+    ImageWriter image_writer;
+
+    /* Frustum culling counters of the last frame */
+    CullStats cull_stats;
+    float title_timer = 0.0f;
+
+    /* Mesh totals are reported once the streamer has remeshed everything in a new mode */
+    bool report_meshing = false;
+
     /* Handle mouse */
     while (!glfwWindowShouldClose(window)) {
         /* Update chunks */
-        updateChunks(BlockTestWorldGenerator, terrain, chunks, camera.GetPosition());
+        streamer.Update(camera.GetPosition(), camera.GetFront(), meshing_mode);
 
         /* Poll events */
         glfwPollEvents();
 
+        /* Deliver finished framebuffer reads */
+        readback.Poll();
+
         /* Calculate delta time in ms */
 		current_time = std::chrono::high_resolution_clock::now();
 		delta_time = std::chrono::duration<float, std::milli>(current_time - last_time).count();
 		last_time = current_time;        
 
 		/* Parse inputs */
-		parseInputs(window, chunks, camera, delta_time);
+		MeshingMode previous_mode = meshing_mode;
+		parseInputs(window, world, camera, delta_time);
+
+        /* The streamer remeshes every chunk in the new mode from its next update */
+        if (meshing_mode != previous_mode) {
+            report_meshing = true;
+        } else if (report_meshing && streamer.GetMode() == meshing_mode) {
+            StreamingStats streaming_stats = streamer.GetStats();
+            if (streaming_stats.queued == 0 && streaming_stats.inFlight == 0 && streaming_stats.pendingUploads == 0) {
+                report_meshing = false;
+                reportMeshStats(chunks);
+            }
+        }
+
+        /* Rebuild sections touched by edits, once each however many blocks changed */
+        world.FlushDirty([&](Chunk& chunk, uint64_t sections) {
+            /* Chunks still waiting for their first mesh pick the edits up then */
+            if (chunk.HasMesh()) {
+                CreateChunkMesh(world_arena, chunk, GetChunkBorders(chunks, chunk.GetPosition()), streamer.GetMode(), sections);
+            }
+        });
 
         /* Draw world */
         {
-            /* Set projection, view, model, and normal matrices */
-            glm::mat4 proj = glm::perspective(glm::radians(45.0f), (float)WIDTH / (float)HEIGHT, 0.1f, 250.0f);
-            glm::mat4 view = camera.GetViewMatrix();
-            glm::mat4 model = glm::mat4(1.0f);
-            glm::mat4 normal = glm::transpose(glm::inverse(model));
-
-            /* Set uniform */
-            world_program.SetUniformMat4f("u_Projection", proj);
-            world_program.SetUniformMat4f("u_View", view);
-            world_program.SetUniformMat4f("u_Model", model);
-            world_program.SetUniformMat4f("u_NormalMatrix", normal);
+            /* Upload camera data once for every program */
+            CameraUniforms camera_uniforms;
+            camera_uniforms.projection = glm::perspective(glm::radians(45.0f), (float)WIDTH / (float)HEIGHT, 0.1f, 250.0f);
+            camera_uniforms.view = camera.GetViewMatrix();
+            camera_uniforms.viewProjection = camera_uniforms.projection * camera_uniforms.view;
+            camera_uniforms.screenProjection = glm::ortho(0.0f, static_cast<float>(WIDTH), 0.0f, static_cast<float>(HEIGHT), -1.0f, 1.0f);
+            camera_uniforms.position = glm::vec4(camera.GetPosition(), 1.0f);
+            camera_uniforms.viewport = glm::vec4(WIDTH, HEIGHT, 1.0f / WIDTH, 1.0f / HEIGHT);
+            camera_buffer.SetData(camera_uniforms);
 
             /* Clear the screen */
             glClearColor(0.5f, 0.7f, 1.0f, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-            /* Draw */
-            for (const auto& chunk_tuple : chunks) {
-                const auto& [_, chunk] = chunk_tuple;
-                chunk.GetMesh().Draw(world_program);
-            }  
+            /* Queue chunks inside the view frustum */
+            Frustum frustum(camera_uniforms.viewProjection);
+            cull_stats = {};
+            world_arena.ClearDraws();
+
+            for (const Chunk& chunk : chunks) {
+                if (!chunk.HasMesh()) {
+                    continue;
+                }
+
+                if (!frustum.IsBoxVisible(chunk.GetBounds())) {
+                    cull_stats.culled++;
+                    continue;
+                }
+
+                /* Sections are drawn separately, skip the ones outside the frustum too */
+                glm::ivec2 origin = chunk.GetPosition() * CHUNK_SIZE;
+                for (int section = 0; section < chunk.GetSectionCount(); section++) {
+                    const ArenaAllocation& mesh = chunk.GetSectionMesh(section);
+                    if (mesh.IsValid() && (chunk.GetSectionCount() == 1 || frustum.IsBoxVisible(chunk.GetSectionBounds(section)))) {
+                        world_arena.AddDraw(mesh, glm::vec3(origin.x, 0.0f, origin.y));
+                    }
+                }
+
+                cull_stats.visible++;
+            }
+
+            /* Draw every chunk at once */
+            terrain.Bind(0);
+            world_program.Bind();
+            world_arena.Draw();
+        }
+
+        /* Show culling and state counters once a second, binds are summed over that second */
+        title_timer += delta_time;
+        if (title_timer >= 1000.0f) {
+            title_timer = 0.0f;
+
+            ArenaStats arena_stats = world_arena.GetStats();
+            StateCacheStats state_stats = StateCache::Get().GetStats();
+            StreamingStats streaming_stats = streamer.GetStats();
+            ChunkCacheStats cache_stats = chunk_cache.GetStats();
+            StateCache::Get().ResetStats();
+
+            std::string title = "Minecraft - " + std::to_string(cull_stats.visible) + " chunks visible, " + std::to_string(cull_stats.culled) + " culled, " + std::to_string(arena_stats.drawCalls) + " draw calls, " + std::to_string(state_stats.issued) + " binds issued, " + std::to_string(state_stats.elided) + " elided, " + std::to_string(streaming_stats.queued + streaming_stats.inFlight + streaming_stats.pendingUploads) + " chunks loading, " + std::to_string(streaming_stats.uploadBytes / 1024) + " KB uploaded, " + std::to_string(cache_stats.hits) + "/" + std::to_string(cache_stats.hits + cache_stats.misses) + " cache hits";
+            glfwSetWindowTitle(window, title.c_str());
         }
 
         /* Draw crosshair */
         {
-            /* Obtain crosshair */
-            glReadPixels(CROSSHAIR_X, CROSSHAIR_Y, CROSSHAIR_SIZE, CROSSHAIR_SIZE, GL_RGBA, GL_UNSIGNED_BYTE, crosshair);
+            /* Invert what is behind it on the GPU, colour = 1 - destination, alpha kept */
+            glDisable(GL_DEPTH_TEST);
+            glBlendFuncSeparate(GL_ONE_MINUS_DST_COLOR, GL_ZERO, GL_ZERO, GL_ONE);
 
-            /* Create texture  */
-            std::shared_ptr<Texture> crosshair_texture = std::make_shared<Texture>(CROSSHAIR_SIZE, CROSSHAIR_SIZE, crosshair, ComponentType::RGBA);
-            crosshair_texture->SetWrapMode(WrapMode::CLAMP_TO_EDGE);
-            crosshair_texture->SetFilterMode(FilterMode::NEAREST, FilterMode::NEAREST);
+            crosshair_mesh.Draw(crosshair_program);
 
-            /* Projection */
-            glm::mat4 proj = glm::ortho(0.0f, static_cast<float>(WIDTH), 0.0f, static_cast<float>(HEIGHT), -1.0f, 1.0f);
-            glm::mat4 model = glm::mat4(1.0f);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glEnable(GL_DEPTH_TEST);
+        }
 
-            /* Set uniform */
-            crosshair_program.SetUniformMat4f("u_Projection", proj);
-            crosshair_program.SetUniformMat4f("u_Model", model);
+        /* Capture the finished frame */
+        if (screenshot_requested) {
+            screenshot_requested = false;
 
-            /* Draw */
-            crosshair_mesh.SetTextures({ crosshair_stencil, crosshair_texture });
-            crosshair_mesh.Draw(crosshair_program);
+            std::string name = "screenshot_" + std::to_string(std::chrono::system_clock::now().time_since_epoch() / std::chrono::milliseconds(1)) + ".png";
+            std::filesystem::path path = screenshots_path / name;
+            readback.Read(0, 0, WIDTH, HEIGHT, [&image_writer, path](ReadbackImage&& image) {
+                image_writer.Save(path, std::move(image));
+            });
         }
 
         /* Swap buffers */
         glfwSwapBuffers(window);
     }
 
+    /* Hand screenshots from the last frames to the writer, it finishes them when it's destroyed */
+    readback.Flush();
+
+    /* Write back whatever is still loaded before the writer stops */
+    streamer.SaveAll();
+    storage.Flush();
+    std::cout << "Chunks saved: " << storage.GetStats().saves << std::endl;
+
     /* Terminate GLFW */
     glfwTerminate();
 }
\ No newline at end of file
@@ -0,0 +1,698 @@
+#include "meshing.h"
+#include "chunks.h"
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Texture axes (u, v) of each face, matching the corner order in faceCorners */
+constexpr int faceAxes[][2] = {
+	{ 0, 1 }, // FRONT
+	{ 0, 1 }, // BACK
+	{ 2, 1 }, // LEFT
+	{ 2, 1 }, // RIGHT
+	{ 0, 2 }, // TOP
+	{ 0, 2 }, // BOTTOM
+};
+
+constexpr int directions[][3] = {
+	{  0,  0,  1 },
+	{  0,  0, -1 },
+	{ -1,  0,  0 },
+	{  1,  0,  0 },
+	{  0,  1,  0 },
+	{  0, -1,  0 },
+};
+
+const char* MeshingModeToString(MeshingMode mode) {
+	switch (mode) {
+	case MeshingMode::NAIVE:
+		return "NAIVE";
+	case MeshingMode::GREEDY:
+		return "GREEDY";
+	case MeshingMode::BINARY:
+		return "BINARY";
+	case MeshingMode::BINARY_GREEDY:
+		return "BINARY_GREEDY";
+	default:
+		return "UNKNOWN";
+	}
+}
+
+/* Unit face corners in counter-clockwise order, stretched along the texture axes for merged faces */
+constexpr int faceCorners[][4][3] = {
+	{ { 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 } }, // FRONT
+	{ { 1, 0, 0 }, { 0, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } }, // BACK
+	{ { 0, 0, 0 }, { 0, 0, 1 }, { 0, 1, 1 }, { 0, 1, 0 } }, // LEFT
+	{ { 1, 0, 1 }, { 1, 0, 0 }, { 1, 1, 0 }, { 1, 1, 1 } }, // RIGHT
+	{ { 0, 1, 1 }, { 1, 1, 1 }, { 1, 1, 0 }, { 0, 1, 0 } }, // TOP
+	{ { 1, 0, 1 }, { 0, 0, 1 }, { 0, 0, 0 }, { 1, 0, 0 } }, // BOTTOM
+};
+
+/* Quad corners as packed offsets, so a vertex is the packed position plus the extent scaled steps */
+struct FaceVertexTemplate {
+	uint32_t offset; // Fixed corner offset and face bits
+	uint32_t uStep;  // Added once per block along the u axis, zero if the corner isn't stretched
+	uint32_t vStep;  // Added once per block along the v axis
+};
+
+static constexpr std::array<std::array<FaceVertexTemplate, 4>, 6> BuildFaceTemplates() {
+	constexpr uint32_t axisSteps[] = {
+		ChunkVertex::Pack(1, 0, 0, BlockFace::FRONT),
+		ChunkVertex::Pack(0, 1, 0, BlockFace::FRONT),
+		ChunkVertex::Pack(0, 0, 1, BlockFace::FRONT),
+	};
+
+	std::array<std::array<FaceVertexTemplate, 4>, 6> templates = {};
+	for (int face = 0; face < 6; face++) {
+		const int uAxis = faceAxes[face][0];
+		const int vAxis = faceAxes[face][1];
+		const int nAxis = 3 - uAxis - vAxis;
+
+		for (int corner = 0; corner < 4; corner++) {
+			const int* unit = faceCorners[face][corner];
+
+			FaceVertexTemplate& entry = templates[face][corner];
+			entry.offset = ChunkVertex::Pack(0, 0, 0, static_cast<BlockFace>(face)) + unit[nAxis] * axisSteps[nAxis];
+			entry.uStep = unit[uAxis] * axisSteps[uAxis];
+			entry.vStep = unit[vAxis] * axisSteps[vAxis];
+		}
+	}
+
+	return templates;
+}
+
+constexpr auto faceTemplates = BuildFaceTemplates();
+constexpr unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+
+/* Packed base and overlay materials of every (face, block) pair */
+struct FaceMaterial {
+	uint32_t base;
+	uint32_t overlay;
+	bool hasOverlay;
+};
+
+static constexpr std::array<std::array<FaceMaterial, BLOCK_TYPE_COUNT>, 6> BuildFaceMaterials() {
+	std::array<std::array<FaceMaterial, BLOCK_TYPE_COUNT>, 6> table = {};
+	for (int face = 0; face < 6; face++) {
+		for (int type = 0; type < BLOCK_TYPE_COUNT; type++) {
+			BlockTexture texture = GetBlockTexture(static_cast<BlockType>(type), static_cast<BlockFace>(face));
+			BlockTexture overlay = GetBlockOverlay(static_cast<BlockType>(type), static_cast<BlockFace>(face));
+
+			FaceMaterial& entry = table[face][type];
+			entry.base = ChunkVertex::PackMaterial(texture.tile, texture.tint);
+			entry.hasOverlay = overlay.tile != NO_TILE;
+			entry.overlay = entry.hasOverlay ? ChunkVertex::PackMaterial(overlay.tile, overlay.tint) : 0;
+		}
+	}
+
+	return table;
+}
+
+constexpr auto faceMaterials = BuildFaceMaterials();
+
+void MeshBuilder::Clear() {
+	m_Vertices.clear();
+	m_Indices.clear();
+	m_Stats = {};
+}
+
+void MeshBuilder::Reserve(size_t quads) {
+	m_Vertices.reserve(quads * 4);
+	m_Indices.reserve(quads * 6);
+}
+
+void MeshBuilder::AddQuad(BlockFace face, glm::ivec3 position, glm::ivec2 extent, uint32_t material) {
+	const uint32_t packed = ChunkVertex::Pack(position.x, position.y, position.z, BlockFace::FRONT);
+	const unsigned int first = static_cast<unsigned int>(m_Vertices.size());
+
+	/* Texture coordinates and normals are derived from the face in the shader */
+	for (const auto& corner : faceTemplates[static_cast<int>(face)]) {
+		uint32_t vertex = packed + corner.offset + corner.uStep * static_cast<uint32_t>(extent.x) + corner.vStep * static_cast<uint32_t>(extent.y);
+		m_Vertices.push_back({ vertex, material });
+	}
+
+	for (unsigned int index : quadIndices) {
+		m_Indices.push_back(first + index);
+	}
+
+	/* One quad per layer, the naive mesher would need one per block */
+	m_Stats.quads++;
+	m_Stats.faces += static_cast<size_t>(extent.x * extent.y);
+}
+
+void MeshBuilder::AddFace(BlockType type, BlockFace face, glm::ivec3 position, glm::ivec2 extent) {
+	const FaceMaterial& material = faceMaterials[static_cast<int>(face)][static_cast<int>(type)];
+
+	/* Base texture, then the tinted overlay on top */
+	AddQuad(face, position, extent, material.base);
+	if (material.hasOverlay) {
+		AddQuad(face, position, extent, material.overlay);
+	}
+}
+
+MeshStats MeshBuilder::GetStats() const {
+	MeshStats stats = m_Stats;
+	stats.vertices = m_Vertices.size();
+	stats.indices = m_Indices.size();
+	return stats;
+}
+
+MeshBuilder& MeshBuilder::GetThreadLocal() {
+	thread_local MeshBuilder builder;
+	return builder;
+}
+
+static inline int CountTrailingZeros(uint32_t value) {
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+/*
+ * Build the visible faces of a padded section as bit planes. One pass over
+ * the padded blocks turns every column along each axis into an 18-bit
+ * occupancy mask, bit 0 and bit SECTION_SIZE + 1 holding the neighbouring
+ * blocks, plus a second mask of the opaque ones. A block bit followed by a
+ * clear opaque bit is a face, so a whole column is culled with a shift, a
+ * NOT and an AND. The result is planes[direction][slice][v] with bit u set
+ * for each visible face, using the face's texture axes.
+ */
+static void BuildFacePlanes(const BlockType* blocks, uint32_t planes[6][SECTION_SIZE][SECTION_SIZE]) {
+	constexpr int padded = SECTION_SIZE + 2;
+	constexpr uint32_t interior = ((1u << SECTION_SIZE) - 1) << 1;
+	static_assert(padded <= 32, "Padded columns must fit in 32 bits");
+
+	/* Columns along x, y and z, indexed by their other two padded coordinates, high axis first */
+	uint32_t columns[3][padded][padded] = {};
+	uint32_t opaques[3][padded][padded] = {};
+
+	for (int z = 0; z < padded; z++) {
+		for (int y = 0; y < padded; y++) {
+			const BlockType* row = &blocks[y * padded + z * padded * padded];
+			for (int x = 0; x < padded; x++) {
+				const uint32_t solid = row[x] != BlockType::AIR;
+				const uint32_t opaque = IsBlockOpaque(row[x]);
+
+				columns[0][z][y] |= solid << x;
+				columns[1][z][x] |= solid << y;
+				columns[2][y][x] |= solid << z;
+				opaques[0][z][y] |= opaque << x;
+				opaques[1][z][x] |= opaque << y;
+				opaques[2][y][x] |= opaque << z;
+			}
+		}
+	}
+
+	std::fill(&planes[0][0][0], &planes[0][0][0] + 6 * SECTION_SIZE * SECTION_SIZE, 0u);
+
+	for (int axis = 0; axis < 3; axis++) {
+		/* The two axes spanning the columns of this axis, i runs along a and j along b */
+		const int a = axis == 0 ? 1 : 0;
+
+		/* Face directions along this axis, positive first */
+		const int positive = axis == 0 ? 3 : axis == 1 ? 4 : 0;
+		const int negative = axis == 0 ? 2 : axis == 1 ? 5 : 1;
+
+		for (int j = 0; j < SECTION_SIZE; j++) {
+			for (int i = 0; i < SECTION_SIZE; i++) {
+				const uint32_t column = columns[axis][j + 1][i + 1];
+				const uint32_t opaque = opaques[axis][j + 1][i + 1];
+
+				/* A block with no opaque block after (positive) or before (negative) */
+				const uint32_t faces[2] = {
+					(column & ~(opaque >> 1)) & interior,
+					(column & ~(opaque << 1)) & interior,
+				};
+
+				for (int side = 0; side < 2; side++) {
+					const int direction = side == 0 ? positive : negative;
+					const int uAxis = faceAxes[direction][0];
+
+					/* Scatter face bits into the slice planes */
+					for (uint32_t bits = faces[side] >> 1; bits; bits &= bits - 1) {
+						int slice = CountTrailingZeros(bits);
+						int u = uAxis == a ? i : j;
+						int v = uAxis == a ? j : i;
+						planes[direction][slice][v] |= 1u << u;
+					}
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Faces merge when they look the same, not only when the block types match,
+ * so give every (block, face) pair the id of the first block with an
+ * identical texture, tint and overlay.
+ */
+static constexpr std::array<std::array<int, BLOCK_TYPE_COUNT>, 6> BuildMergeMaterials() {
+	std::array<std::array<int, BLOCK_TYPE_COUNT>, 6> table = {};
+	for (int face = 0; face < 6; face++) {
+		for (int type = 0; type < BLOCK_TYPE_COUNT; type++) {
+			const FaceMaterial& material = faceMaterials[face][type];
+
+			table[face][type] = type;
+			for (int other = 1; other < type; other++) {
+				const FaceMaterial& candidate = faceMaterials[face][other];
+				if (material.base == candidate.base && material.hasOverlay == candidate.hasOverlay && material.overlay == candidate.overlay) {
+					table[face][type] = other;
+					break;
+				}
+			}
+		}
+	}
+
+	return table;
+}
+
+constexpr auto mergeMaterials = BuildMergeMaterials();
+
+uint8_t GetChunkNeighbours(const ChunkMap& chunks, glm::ivec2 position) {
+	uint8_t neighbours = 0;
+	for (int side = 0; side < CHUNK_NEIGHBOUR_COUNT; side++) {
+		if (chunks.Contains(GetChunkNeighbour(position, side))) {
+			neighbours |= 1u << side;
+		}
+	}
+
+	return neighbours;
+}
+
+ChunkBorders GetChunkBorders(const ChunkMap& chunks, glm::ivec2 position) {
+	ChunkBorders borders;
+	for (int side = 0; side < CHUNK_NEIGHBOUR_COUNT; side++) {
+		const Chunk* neighbour = chunks.Find(GetChunkNeighbour(position, side));
+		if (neighbour == nullptr) {
+			continue;
+		}
+
+		/* The neighbour's layer facing back at this chunk */
+		const int height = neighbour->GetHeight();
+		const bool alongX = side == static_cast<int>(BlockFace::FRONT) || side == static_cast<int>(BlockFace::BACK);
+		const int layer = side == static_cast<int>(BlockFace::FRONT) || side == static_cast<int>(BlockFace::RIGHT) ? 0 : SECTION_SIZE - 1;
+
+		std::vector<BlockType>& slice = borders.slices[side];
+		slice.resize(static_cast<size_t>(height) * SECTION_SIZE);
+		for (int y = 0; y < height; y++) {
+			for (int u = 0; u < SECTION_SIZE; u++) {
+				slice[y * SECTION_SIZE + u] = alongX ? neighbour->GetBlock(u, y, layer) : neighbour->GetBlock(layer, y, u);
+			}
+		}
+
+		borders.revisions[side] = neighbour->GetRevision();
+		borders.neighbours |= 1u << side;
+	}
+
+	return borders;
+}
+
+/* Whether every neighbour has an opaque wall against the rows of a section */
+static bool IsSectionWalledIn(const ChunkBorders& borders, int section) {
+	for (int side = 0; side < CHUNK_NEIGHBOUR_COUNT; side++) {
+		const std::vector<BlockType>& slice = borders.slices[side];
+		const size_t first = static_cast<size_t>(section) * SECTION_SIZE * SECTION_SIZE;
+		if (!borders.HasNeighbour(side) || slice.size() < first + SECTION_SIZE * SECTION_SIZE) {
+			return false;
+		}
+
+		for (size_t i = first; i < first + SECTION_SIZE * SECTION_SIZE; i++) {
+			if (!IsBlockOpaque(slice[i])) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/* Mesh one section of the chunk into the builder, nothing if it can't be seen */
+static void MeshSection(const Chunk& chunk, const ChunkBorders& borders, int section, MeshingMode mode, MeshBuilder& builder) {
+	/* Section blocks with a one block border, so neighbour lookups need no bounds checks */
+	constexpr int padded = SECTION_SIZE + 2;
+	constexpr int strides[] = { 1, padded, padded * padded };
+	thread_local std::vector<BlockType> decoded(SECTION_VOLUME);
+	thread_local std::vector<BlockType> blocks(padded * padded * padded);
+
+	auto paddedIndex = [&](int x, int y, int z) {
+		return (x + 1) * strides[0] + (y + 1) * strides[1] + (z + 1) * strides[2];
+	};
+
+	/* Skip sections with nothing to draw */
+	if (chunk.GetSection(section).IsEmpty() || (chunk.IsSectionOccluded(section) && IsSectionWalledIn(borders, section))) {
+		return;
+	}
+
+	/* Missing neighbours and the unused corners of the border read as air */
+	std::fill(blocks.begin(), blocks.end(), BlockType::AIR);
+
+	/* Copy section into the padded buffer */
+	chunk.GetSection(section).Decode(decoded.data());
+	for (int z = 0; z < SECTION_SIZE; z++) {
+		for (int y = 0; y < SECTION_SIZE; y++) {
+			const BlockType* row = &decoded[GetBlockIndex(0, y, z, SECTION_SIZE, SECTION_SIZE, SECTION_SIZE)];
+			std::copy(row, row + SECTION_SIZE, &blocks[paddedIndex(0, y, z)]);
+		}
+	}
+
+	/* Copy touching layers of the sections above and below */
+	int baseY = section * SECTION_SIZE;
+	for (int z = 0; z < SECTION_SIZE; z++) {
+		for (int x = 0; x < SECTION_SIZE; x++) {
+			blocks[paddedIndex(x, -1, z)] = chunk.GetBlock(x, baseY - 1, z);
+			blocks[paddedIndex(x, SECTION_SIZE, z)] = chunk.GetBlock(x, baseY + SECTION_SIZE, z);
+		}
+	}
+
+	/* Copy the neighbouring chunks' layers into the horizontal border */
+	for (int side = 0; side < CHUNK_NEIGHBOUR_COUNT; side++) {
+		const std::vector<BlockType>& slice = borders.slices[side];
+		if (slice.size() < static_cast<size_t>(baseY + SECTION_SIZE) * SECTION_SIZE) {
+			continue;
+		}
+
+		/* Padded position of the slice's first block and its step along u */
+		const bool alongX = side == static_cast<int>(BlockFace::FRONT) || side == static_cast<int>(BlockFace::BACK);
+		const int outside = side == static_cast<int>(BlockFace::BACK) || side == static_cast<int>(BlockFace::LEFT) ? -1 : SECTION_SIZE;
+		const int first = alongX ? paddedIndex(0, 0, outside) : paddedIndex(outside, 0, 0);
+		const int uStride = alongX ? strides[0] : strides[2];
+
+		for (int y = 0; y < SECTION_SIZE; y++) {
+			const BlockType* row = &slice[(baseY + y) * SECTION_SIZE];
+			for (int u = 0; u < SECTION_SIZE; u++) {
+				blocks[first + y * strides[1] + u * uStride] = row[u];
+			}
+		}
+	}
+
+	glm::ivec3 sectionOrigin = glm::ivec3(0, baseY, 0);
+
+	if (mode == MeshingMode::NAIVE) {
+		for (int y = 0; y < SECTION_SIZE; y++) {
+			for (int z = 0; z < SECTION_SIZE; z++) {
+				for (int x = 0; x < SECTION_SIZE; x++) {
+					/* Get block type */
+					int current = paddedIndex(x, y, z);
+					BlockType type = blocks[current];
+					if (type == BlockType::AIR) {
+						continue;
+					}
+
+					/* Check for faces */
+					for (int direction = 0; direction < 6; direction++) {
+						int step = directions[direction][0] * strides[0] + directions[direction][1] * strides[1] + directions[direction][2] * strides[2];
+						if (!IsBlockOpaque(blocks[current + step])) {
+							builder.AddFace(type, static_cast<BlockFace>(direction), sectionOrigin + glm::ivec3(x, y, z), glm::ivec2(1));
+						}
+					}
+				}
+			}
+		}
+
+		return;
+	}
+
+	if (mode == MeshingMode::BINARY || mode == MeshingMode::BINARY_GREEDY) {
+		uint32_t planes[6][SECTION_SIZE][SECTION_SIZE];
+		BuildFacePlanes(blocks.data(), planes);
+
+		for (int direction = 0; direction < 6; direction++) {
+			const int uAxis = faceAxes[direction][0];
+			const int vAxis = faceAxes[direction][1];
+			const int nAxis = 3 - uAxis - vAxis;
+
+			for (int slice = 0; slice < SECTION_SIZE; slice++) {
+				uint32_t* rows = planes[direction][slice];
+
+				auto blockAt = [&](int u, int v) {
+					int local[3];
+					local[uAxis] = u;
+					local[vAxis] = v;
+					local[nAxis] = slice;
+					return blocks[paddedIndex(local[0], local[1], local[2])];
+				};
+
+				auto facePosition = [&](int u, int v) {
+					glm::ivec3 position = sectionOrigin;
+					position[uAxis] += u;
+					position[vAxis] += v;
+					position[nAxis] += slice;
+					return position;
+				};
+
+				if (mode == MeshingMode::BINARY) {
+					for (int v = 0; v < SECTION_SIZE; v++) {
+						for (uint32_t bits = rows[v]; bits; bits &= bits - 1) {
+							int u = CountTrailingZeros(bits);
+							builder.AddFace(blockAt(u, v), static_cast<BlockFace>(direction), facePosition(u, v), glm::ivec2(1));
+						}
+					}
+
+					continue;
+				}
+
+				/* Split the plane per material */
+				uint32_t materialRows[BLOCK_TYPE_COUNT][SECTION_SIZE];
+				BlockType materialTypes[BLOCK_TYPE_COUNT];
+				uint32_t used = 0; // Bit per material, BLOCK_TYPE_COUNT is capped at 32 in blocks.h
+
+				for (int v = 0; v < SECTION_SIZE; v++) {
+					for (uint32_t bits = rows[v]; bits; bits &= bits - 1) {
+						int u = CountTrailingZeros(bits);
+						BlockType type = blockAt(u, v);
+						int material = mergeMaterials[direction][static_cast<int>(type)];
+
+						if (!(used & (1u << material))) {
+							used |= 1u << material;
+							materialTypes[material] = type;
+							std::fill(materialRows[material], materialRows[material] + SECTION_SIZE, 0u);
+						}
+
+						materialRows[material][v] |= 1u << u;
+					}
+				}
+
+				/* Bitwise greedy merge, runs along u grow down v while the whole run is present */
+				for (uint32_t pending = used; pending; pending &= pending - 1) {
+					int material = CountTrailingZeros(pending);
+					uint32_t* materialPlane = materialRows[material];
+
+					for (int v = 0; v < SECTION_SIZE; v++) {
+						while (materialPlane[v]) {
+							int u = CountTrailingZeros(materialPlane[v]);
+							int width = CountTrailingZeros(~(materialPlane[v] >> u));
+							uint32_t run = ((width >= 32 ? 0u : (1u << width)) - 1u) << u;
+
+							int height = 1;
+							while (v + height < SECTION_SIZE && (materialPlane[v + height] & run) == run) {
+								materialPlane[v + height] &= ~run;
+								height++;
+							}
+
+							materialPlane[v] &= ~run;
+							builder.AddFace(materialTypes[material], static_cast<BlockFace>(direction), facePosition(u, v), glm::ivec2(width, height));
+						}
+					}
+				}
+			}
+		}
+
+		return;
+	}
+
+	/* Greedy: sweep each face direction one slice at a time */
+	for (int direction = 0; direction < 6; direction++) {
+		const int uAxis = faceAxes[direction][0];
+		const int vAxis = faceAxes[direction][1];
+		const int nAxis = 3 - uAxis - vAxis;
+		const int step = directions[direction][0] * strides[0] + directions[direction][1] * strides[1] + directions[direction][2] * strides[2];
+
+		for (int slice = 0; slice < SECTION_SIZE; slice++) {
+			/* Material of the visible face at each cell, -1 if there is none */
+			int mask[SECTION_SIZE][SECTION_SIZE];
+			BlockType types[SECTION_SIZE][SECTION_SIZE];
+
+			for (int v = 0; v < SECTION_SIZE; v++) {
+				for (int u = 0; u < SECTION_SIZE; u++) {
+					int local[3];
+					local[uAxis] = u;
+					local[vAxis] = v;
+					local[nAxis] = slice;
+
+					int current = paddedIndex(local[0], local[1], local[2]);
+					BlockType type = blocks[current];
+
+					mask[v][u] = -1;
+					types[v][u] = type;
+					if (type != BlockType::AIR && !IsBlockOpaque(blocks[current + step])) {
+						mask[v][u] = mergeMaterials[direction][static_cast<int>(type)];
+					}
+				}
+			}
+
+			/* Grow maximal rectangles, first along u then along v */
+			for (int v = 0; v < SECTION_SIZE; v++) {
+				for (int u = 0; u < SECTION_SIZE;) {
+					int material = mask[v][u];
+					if (material == -1) {
+						u++;
+						continue;
+					}
+
+					int width = 1;
+					while (u + width < SECTION_SIZE && mask[v][u + width] == material) {
+						width++;
+					}
+
+					int height = 1;
+					for (bool grow = true; grow && v + height < SECTION_SIZE; ) {
+						for (int k = 0; k < width; k++) {
+							if (mask[v + height][u + k] != material) {
+								grow = false;
+								break;
+							}
+						}
+
+						if (grow) {
+							height++;
+						}
+					}
+
+					/* Consume the rectangle */
+					for (int dv = 0; dv < height; dv++) {
+						for (int du = 0; du < width; du++) {
+							mask[v + dv][u + du] = -1;
+						}
+					}
+
+					glm::ivec3 position = sectionOrigin;
+					position[uAxis] += u;
+					position[vAxis] += v;
+					position[nAxis] += slice;
+
+					builder.AddFace(types[v][u], static_cast<BlockFace>(direction), position, glm::ivec2(width, height));
+					u += width;
+				}
+			}
+		}
+	}
+}
+
+ChunkMeshData BuildChunkMesh(const Chunk& chunk, const ChunkBorders& borders, MeshingMode mode, uint64_t sections) {
+	ChunkMeshData data;
+	BuildChunkMesh(chunk, borders, mode, sections, data);
+	return data;
+}
+
+void BuildChunkMesh(const Chunk& chunk, const ChunkBorders& borders, MeshingMode mode, uint64_t sections, ChunkMeshData& data) {
+	/* Reused between calls, the builder stops allocating once it fits the largest section */
+	MeshBuilder& builder = MeshBuilder::GetThreadLocal();
+
+	data.neighbours = borders.neighbours;
+	data.revision = chunk.GetRevision();
+	data.neighbourRevisions = borders.revisions;
+	data.mode = mode;
+
+	size_t count = 0;
+	for (int section = 0; section < chunk.GetSectionCount(); section++) {
+		if (!((sections >> section) & 1)) {
+			continue;
+		}
+
+		builder.Clear();
+		MeshSection(chunk, borders, section, mode, builder);
+
+		/* Copy out, the builder stays with this thread. Arrays left from earlier data only allocate if they're too small */
+		if (count == data.sections.size()) {
+			data.sections.emplace_back();
+		}
+
+		SectionMeshData& mesh = data.sections[count++];
+		mesh.section = section;
+		mesh.vertices.assign(builder.GetVertices().begin(), builder.GetVertices().end());
+		mesh.indices.assign(builder.GetIndices().begin(), builder.GetIndices().end());
+		mesh.stats = builder.GetStats();
+	}
+
+	data.sections.resize(count);
+}
+
+render::VertexBufferLayout GetChunkVertexLayout() {
+	render::VertexBufferLayout layout;
+	layout.PushInteger<unsigned int>(1); // Position and face
+	layout.PushInteger<unsigned int>(1); // Texture layer and tint
+	return layout;
+}
+
+render::VertexBufferLayout GetChunkInstanceLayout() {
+	render::VertexBufferLayout layout;
+	layout.Push<float>(3); // Chunk origin
+	return layout;
+}
+
+/* Sections without geometry drop their old allocation and get none */
+static render::ArenaAllocation AllocateSection(render::GeometryArena& arena, const std::vector<ChunkVertex>& vertices, const std::vector<unsigned int>& indices) {
+	if (indices.empty()) {
+		return {};
+	}
+
+	return arena.Allocate(vertices, indices);
+}
+
+size_t ChunkMeshData::GetSize() const {
+	size_t size = 0;
+	for (const SectionMeshData& mesh : sections) {
+		size += mesh.vertices.size() * sizeof(ChunkVertex) + mesh.indices.size() * sizeof(unsigned int);
+	}
+
+	return size;
+}
+
+void UploadChunkMesh(render::GeometryArena& arena, Chunk& chunk, const ChunkMeshData& data) {
+	for (const SectionMeshData& mesh : data.sections) {
+		if (mesh.section < chunk.GetSectionCount()) {
+			chunk.SetSectionMesh(mesh.section, AllocateSection(arena, mesh.vertices, mesh.indices), mesh.stats);
+		}
+	}
+
+	/* Only a full rebuild has culled every border against these neighbours */
+	const bool complete = static_cast<int>(data.sections.size()) == chunk.GetSectionCount();
+	chunk.SetMeshed(complete || !chunk.HasMesh() ? data.neighbours : chunk.GetMeshNeighbours());
+}
+
+MeshStats CreateChunkMesh(render::GeometryArena& arena, Chunk& chunk, const ChunkBorders& borders, MeshingMode mode, uint64_t sections) {
+	MeshBuilder& builder = MeshBuilder::GetThreadLocal();
+	MeshStats total;
+	int meshed = 0;
+
+	for (int section = 0; section < chunk.GetSectionCount(); section++) {
+		if (!((sections >> section) & 1)) {
+			continue;
+		}
+
+		builder.Clear();
+		MeshSection(chunk, borders, section, mode, builder);
+
+		/* Upload straight from the builder */
+		MeshStats stats = builder.GetStats();
+		chunk.SetSectionMesh(section, AllocateSection(arena, builder.GetVertices(), builder.GetIndices()), stats);
+		meshed++;
+
+		total.faces += stats.faces;
+		total.quads += stats.quads;
+		total.vertices += stats.vertices;
+		total.indices += stats.indices;
+	}
+
+	chunk.SetMeshed(meshed == chunk.GetSectionCount() || !chunk.HasMesh() ? borders.neighbours : chunk.GetMeshNeighbours());
+	return total;
+}
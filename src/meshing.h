@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <renderer/textures.h>
+#include <renderer/models.h>
+#include <renderer/arena.h>
+
+#include "world.h"
+
+enum class MeshingMode {
+	NAIVE = 0,  // One quad per exposed block face
+	GREEDY,     // Coplanar faces with the same texture and tint merged into rectangles
+	BINARY,     // Faces found from column occupancy bitmasks, one quad per face
+	BINARY_GREEDY, // Bitmask face culling followed by bitwise greedy merging
+};
+
+const char* MeshingModeToString(MeshingMode mode);
+
+/*
+ * Collects chunk quads in chunk local coordinates. Clear() keeps the buffer
+ * capacity, so a builder reused across chunks stops allocating once it has
+ * grown to fit the largest mesh.
+ */
+class MeshBuilder {
+private:
+	std::vector<ChunkVertex> m_Vertices;
+	std::vector<unsigned int> m_Indices;
+	MeshStats m_Stats;
+
+public:
+	void Clear();
+	void Reserve(size_t quads);
+
+	/* Single quad spanning extent blocks along the face's texture axes */
+	void AddQuad(BlockFace face, glm::ivec3 position, glm::ivec2 extent, uint32_t material);
+
+	/* Block face, the base quad followed by its overlay if it has one */
+	void AddFace(BlockType type, BlockFace face, glm::ivec3 position, glm::ivec2 extent = glm::ivec2(1));
+
+	/* Getters */
+	inline const std::vector<ChunkVertex>& GetVertices() const { return m_Vertices; }
+	inline const std::vector<unsigned int>& GetIndices() const { return m_Indices; }
+	MeshStats GetStats() const;
+
+	/* Per thread builder used by CreateChunkMesh */
+	static MeshBuilder& GetThreadLocal();
+};
+
+/* Horizontal neighbours of a chunk, in BlockFace order: FRONT (+z), BACK (-z), LEFT (-x), RIGHT (+x) */
+constexpr int CHUNK_NEIGHBOUR_COUNT = 4;
+constexpr int chunkNeighbourOffsets[CHUNK_NEIGHBOUR_COUNT][2] = {
+	{  0,  1 },
+	{  0, -1 },
+	{ -1,  0 },
+	{  1,  0 },
+};
+
+/* Bit set for every neighbour */
+constexpr uint8_t ALL_CHUNK_NEIGHBOURS = (1u << CHUNK_NEIGHBOUR_COUNT) - 1;
+
+inline glm::ivec2 GetChunkNeighbour(glm::ivec2 position, int side) {
+	return position + glm::ivec2(chunkNeighbourOffsets[side][0], chunkNeighbourOffsets[side][1]);
+}
+
+/*
+ * Read-only copies of the blocks touching a chunk from each loaded
+ * neighbour, so faces on chunk borders are culled against what is really
+ * next to them. A slice is the neighbour's layer against this chunk, row y
+ * at y * SECTION_SIZE, along x for FRONT and BACK and along z for LEFT and
+ * RIGHT. Blocks next to a missing neighbour read as air. Chunks are whole
+ * columns, so there is nothing above or below to copy.
+ */
+struct ChunkBorders {
+	std::array<std::vector<BlockType>, CHUNK_NEIGHBOUR_COUNT> slices;
+	std::array<uint32_t, CHUNK_NEIGHBOUR_COUNT> revisions{}; // Neighbour revision each slice was read at
+	uint8_t neighbours = 0; // Bit per side whose slice is filled in
+
+	inline bool HasNeighbour(int side) const { return (neighbours >> side) & 1; }
+};
+
+/* Bit per horizontal neighbour currently loaded */
+uint8_t GetChunkNeighbours(const ChunkMap& chunks, glm::ivec2 position);
+
+/* Copy the border slices of every loaded neighbour */
+ChunkBorders GetChunkBorders(const ChunkMap& chunks, glm::ivec2 position);
+
+/* Section bits for every section of a chunk */
+constexpr uint64_t ALL_SECTIONS = ~0ULL;
+
+static_assert((MAX_CHUNK_HEIGHT + 1) / SECTION_SIZE <= 64, "sections are selected with a 64 bit mask");
+
+/* CPU side geometry of one section */
+struct SectionMeshData {
+	int section = 0;
+	std::vector<ChunkVertex> vertices;
+	std::vector<unsigned int> indices;
+	MeshStats stats;
+};
+
+/* CPU side chunk geometry, built away from the render thread and uploaded later */
+struct ChunkMeshData {
+	std::vector<SectionMeshData> sections; // Only the sections that were asked for
+	uint8_t neighbours = 0;                // Neighbours the borders were culled against
+	uint32_t revision = 0;                 // Chunk revision the blocks were read at
+	std::array<uint32_t, CHUNK_NEIGHBOUR_COUNT> neighbourRevisions{}; // Their revisions the borders were read at
+	MeshingMode mode = MeshingMode::NAIVE; // Mode it was built in
+
+	/* Vertex and index bytes an upload copies */
+	size_t GetSize() const;
+};
+
+/* Build the geometry of the selected sections without touching OpenGL, safe to call from any thread */
+ChunkMeshData BuildChunkMesh(const Chunk& chunk, const ChunkBorders& borders, MeshingMode mode = MeshingMode::NAIVE, uint64_t sections = ALL_SECTIONS);
+
+/* Same, filling data in place. Its section arrays are overwritten and only grow, so recycled data saves allocating them */
+void BuildChunkMesh(const Chunk& chunk, const ChunkBorders& borders, MeshingMode mode, uint64_t sections, ChunkMeshData& data);
+
+/* Chunk vertices, and the per chunk origin drawn as instance data */
+render::VertexBufferLayout GetChunkVertexLayout();
+render::VertexBufferLayout GetChunkInstanceLayout();
+
+/* Replace the chunk's section meshes with geometry built by BuildChunkMesh, render thread only */
+void UploadChunkMesh(render::GeometryArena& arena, Chunk& chunk, const ChunkMeshData& data);
+
+/* Build and upload the selected sections on the calling thread, returns their combined stats */
+MeshStats CreateChunkMesh(render::GeometryArena& arena, Chunk& chunk, const ChunkBorders& borders, MeshingMode mode = MeshingMode::NAIVE, uint64_t sections = ALL_SECTIONS);
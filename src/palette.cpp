@@ -0,0 +1,147 @@
+#include "palette.h"
+
+#include <array>
+#include <algorithm>
+
+#include "world.h"
+
+PalettedContainer::PalettedContainer(size_t size, BlockType fill) : m_Size(size), m_Bits(0), m_Palette({ fill }) {}
+
+PalettedContainer::PalettedContainer(const BlockType* blocks, size_t size) : m_Size(size), m_Bits(0) {
+	if (size == 0) {
+		m_Palette.push_back(BlockType::AIR);
+		return;
+	}
+
+	/* Build palette */
+	std::array<int, 256> lookup;
+	lookup.fill(-1);
+
+	for (size_t i = 0; i < size; i++) {
+		uint8_t id = static_cast<uint8_t>(blocks[i]);
+		if (lookup[id] == -1) {
+			lookup[id] = static_cast<int>(m_Palette.size());
+			m_Palette.push_back(blocks[i]);
+		}
+	}
+
+	/* Uniform storage needs no indices */
+	m_Bits = BitsForPaletteSize(m_Palette.size());
+	if (m_Bits == 0) {
+		return;
+	}
+
+	/* Pack indices */
+	const size_t perWord = 64 / m_Bits;
+	m_Data.assign((size + perWord - 1) / perWord, 0);
+
+	for (size_t i = 0; i < size; i++) {
+		uint64_t value = static_cast<uint64_t>(lookup[static_cast<uint8_t>(blocks[i])]);
+		m_Data[i / perWord] |= value << ((i % perWord) * m_Bits);
+	}
+}
+
+uint8_t PalettedContainer::BitsForPaletteSize(size_t size) {
+	if (size <= 1) return 0;
+	if (size <= 2) return 1;
+	if (size <= 4) return 2;
+	if (size <= 16) return 4;
+	return 8;
+}
+
+int PalettedContainer::FindPaletteIndex(BlockType type) const {
+	for (size_t i = 0; i < m_Palette.size(); i++) {
+		if (m_Palette[i] == type) {
+			return static_cast<int>(i);
+		}
+	}
+
+	return -1;
+}
+
+int PalettedContainer::AddPaletteEntry(BlockType type) {
+	m_Palette.push_back(type);
+
+	/* Grow index width if the palette no longer fits */
+	uint8_t bits = BitsForPaletteSize(m_Palette.size());
+	if (bits != m_Bits) {
+		Resize(bits);
+	}
+
+	return static_cast<int>(m_Palette.size() - 1);
+}
+
+void PalettedContainer::Resize(uint8_t bits) {
+	const size_t perWord = 64 / bits;
+	std::vector<uint64_t> data((m_Size + perWord - 1) / perWord, 0);
+
+	/* Single value storage is all zero indices, nothing to copy */
+	if (m_Bits != 0) {
+		for (size_t i = 0; i < m_Size; i++) {
+			data[i / perWord] |= static_cast<uint64_t>(GetIndex(i)) << ((i % perWord) * bits);
+		}
+	}
+
+	m_Data = std::move(data);
+	m_Bits = bits;
+}
+
+void PalettedContainer::SetIndex(size_t index, uint32_t value) {
+	const size_t perWord = 64 / m_Bits;
+	const size_t word = index / perWord;
+	const uint32_t offset = static_cast<uint32_t>((index % perWord) * m_Bits);
+	const uint64_t mask = ((1ULL << m_Bits) - 1) << offset;
+
+	m_Data[word] = (m_Data[word] & ~mask) | (static_cast<uint64_t>(value) << offset);
+}
+
+void PalettedContainer::Set(size_t index, BlockType type) {
+	if (index >= m_Size) {
+		return;
+	}
+
+	int paletteIndex = FindPaletteIndex(type);
+	if (paletteIndex == -1) {
+		paletteIndex = AddPaletteEntry(type);
+	}
+
+	if (m_Bits != 0) {
+		SetIndex(index, static_cast<uint32_t>(paletteIndex));
+	}
+}
+
+void PalettedContainer::Fill(BlockType type) {
+	m_Bits = 0;
+	m_Palette.assign(1, type);
+	m_Data.clear();
+	m_Data.shrink_to_fit();
+}
+
+void PalettedContainer::Decode(BlockType* out) const {
+	if (m_Bits == 0) {
+		std::fill(out, out + m_Size, m_Palette[0]);
+		return;
+	}
+
+	/* Decode a whole word at a time */
+	const size_t perWord = 64 / m_Bits;
+	const uint64_t mask = (1ULL << m_Bits) - 1;
+
+	size_t i = 0;
+	for (uint64_t word : m_Data) {
+		size_t count = std::min(perWord, m_Size - i);
+		for (size_t j = 0; j < count; j++) {
+			out[i++] = m_Palette[word & mask];
+			word >>= m_Bits;
+		}
+	}
+}
+
+void PalettedContainer::Decode(std::vector<BlockType>& out) const {
+	out.resize(m_Size);
+	Decode(out.data());
+}
+
+size_t PalettedContainer::GetMemoryUsage() const {
+	return sizeof(*this) + m_Palette.capacity() * sizeof(BlockType) + m_Data.capacity() * sizeof(uint64_t);
+}
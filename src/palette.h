@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+enum class BlockType : uint8_t;
+
+/*
+ * Block storage made of a palette of distinct block types and a bit-packed
+ * array of palette indices. Indices use 1, 2, 4 or 8 bits depending on the
+ * palette size so they never straddle a 64-bit word. A container holding a
+ * single block type stores no index data at all.
+ */
+class PalettedContainer {
+private:
+	size_t m_Size;
+	uint8_t m_Bits;
+	std::vector<BlockType> m_Palette;
+	std::vector<uint64_t> m_Data;
+
+	/* Palette helpers */
+	int FindPaletteIndex(BlockType type) const;
+	int AddPaletteEntry(BlockType type);
+
+	/* Repack indices using a new bit width */
+	void Resize(uint8_t bits);
+
+	static uint8_t BitsForPaletteSize(size_t size);
+
+	inline uint32_t GetIndex(size_t index) const {
+		const uint32_t shift = m_Bits == 1 ? 0 : m_Bits == 2 ? 1 : m_Bits == 4 ? 2 : 3;
+		const size_t word = index >> (6 - shift);
+		const uint32_t offset = static_cast<uint32_t>(index & ((64u >> shift) - 1)) << shift;
+		return static_cast<uint32_t>(m_Data[word] >> offset) & ((1u << m_Bits) - 1);
+	}
+
+	void SetIndex(size_t index, uint32_t value);
+
+public:
+	PalettedContainer(size_t size, BlockType fill);
+	PalettedContainer(const BlockType* blocks, size_t size);
+	PalettedContainer(const std::vector<BlockType>& blocks) : PalettedContainer(blocks.data(), blocks.size()) {}
+
+	/* Access */
+	inline BlockType Get(size_t index) const {
+		if (m_Bits == 0) {
+			return m_Palette[0];
+		}
+
+		return m_Palette[GetIndex(index)];
+	}
+
+	void Set(size_t index, BlockType type);
+	void Fill(BlockType type);
+
+	/* Bulk decode, output must hold GetSize() entries */
+	void Decode(BlockType* out) const;
+	void Decode(std::vector<BlockType>& out) const;
+
+	/* Getters */
+	inline size_t GetSize() const { return m_Size; }
+	inline uint8_t GetBitsPerEntry() const { return m_Bits; }
+	inline bool IsUniform() const { return m_Bits == 0; }
+	inline const std::vector<BlockType>& GetPalette() const { return m_Palette; }
+	size_t GetMemoryUsage() const;
+};
@@ -0,0 +1,508 @@
+#include "raycast.h"
+
+#include <cmath>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <cstdint>
+#include <unordered_map>
+
+#if defined(__AVX2__)
+#define RAYCAST_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RAYCAST_SSE
+#include <emmintrin.h>
+#endif
+
+static_assert((MAX_CHUNK_HEIGHT + 1) / SECTION_SIZE <= 64, "occupancy tracks sections in a 64 bit mask");
+
+/* Division rounding towards negative infinity, for cells left of or behind the origin */
+static inline int FloorDiv(int value, int divisor) {
+	int quotient = value / divisor;
+	return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+/* Traversal state at the ray's origin, shared by both paths so they agree exactly */
+struct RayStart {
+	glm::vec3 direction;
+	glm::ivec3 cell;
+	glm::ivec3 step;
+	glm::vec3 next;  // Distance along the ray to the next boundary on each axis
+	glm::vec3 delta; // Distance between boundaries on each axis
+};
+
+static bool SetupRay(glm::vec3 position, glm::vec3 direction, float distance, RayStart& start) {
+	const float length = glm::length(direction);
+	if (length == 0.0f || !(distance >= 0.0f)) {
+		return false;
+	}
+
+	constexpr float infinity = std::numeric_limits<float>::infinity();
+	start.direction = direction / length;
+	start.cell = glm::ivec3(glm::floor(position));
+
+	for (int axis = 0; axis < 3; axis++) {
+		if (start.direction[axis] > 0.0f) {
+			start.step[axis] = 1;
+			start.delta[axis] = 1.0f / start.direction[axis];
+			start.next[axis] = (start.cell[axis] + 1 - position[axis]) * start.delta[axis];
+		} else if (start.direction[axis] < 0.0f) {
+			start.step[axis] = -1;
+			start.delta[axis] = -1.0f / start.direction[axis];
+			start.next[axis] = (position[axis] - start.cell[axis]) * start.delta[axis];
+		} else {
+			start.step[axis] = 0;
+			start.delta[axis] = infinity;
+			start.next[axis] = infinity;
+		}
+	}
+
+	return true;
+}
+
+static void SetHit(RaycastResult& result, glm::vec3 origin, glm::vec3 direction, float travelled, glm::ivec3 cell, glm::ivec3 normal, BlockType type) {
+	result.position = origin + direction * travelled;
+	result.block = cell;
+	result.normal = normal;
+	result.placement = cell + normal;
+	result.distance = travelled;
+	result.type = type;
+	result.hit = true;
+}
+
+bool Raycast(const WorldSettings& settings, const ChunkMap& chunks, glm::vec3 position, glm::vec3 direction, float distance, RaycastResult& result) {
+	RayStart start;
+	if (!SetupRay(position, direction, distance, start)) {
+		return false;
+	}
+
+	glm::ivec3 cell = start.cell;
+	glm::vec3 next = start.next;
+	glm::ivec3 normal = glm::ivec3(0);
+	float travelled = 0.0f;
+
+	const Chunk* chunk = nullptr;
+	glm::ivec2 chunkPosition = glm::ivec2(0);
+	bool chunkValid = false;
+
+	while (travelled <= distance) {
+		/* Leaving the world vertically means nothing else can be hit */
+		if ((cell.y < 0 && start.step.y <= 0) || (cell.y >= settings.chunk_height && start.step.y >= 0)) {
+			return false;
+		}
+
+		if (cell.y >= 0 && cell.y < settings.chunk_height) {
+			glm::ivec2 current = glm::ivec2(FloorDiv(cell.x, settings.chunk_width), FloorDiv(cell.z, settings.chunk_depth));
+			if (!chunkValid || current != chunkPosition) {
+				chunk = chunks.Find(current);
+				chunkPosition = current;
+				chunkValid = true;
+			}
+
+			if (chunk != nullptr) {
+				BlockType type = chunk->GetBlock(cell.x - current.x * settings.chunk_width, cell.y, cell.z - current.y * settings.chunk_depth);
+				if (IsBlockSolid(type)) {
+					SetHit(result, position, start.direction, travelled, cell, normal, type);
+					return true;
+				}
+			}
+		}
+
+		/* Cross the closest boundary */
+		int axis = next.x < next.y ? (next.x < next.z ? 0 : 2) : (next.y < next.z ? 1 : 2);
+		travelled = next[axis];
+		next[axis] += start.delta[axis];
+		cell[axis] += start.step[axis];
+
+		normal = glm::ivec3(0);
+		normal[axis] = -start.step[axis];
+	}
+
+	return false;
+}
+
+/* IsBlockSolid as a flat table, one byte per block type */
+static constexpr std::array<bool, BLOCK_TYPE_COUNT> BuildSolidBlocks() {
+	std::array<bool, BLOCK_TYPE_COUNT> table = {};
+	for (int type = 0; type < BLOCK_TYPE_COUNT; type++) {
+		table[type] = IsBlockSolid(static_cast<BlockType>(type));
+	}
+
+	return table;
+}
+
+constexpr auto solidBlocks = BuildSolidBlocks();
+
+/*
+ * Solid blocks of every chunk a batch has touched, one 16 bit row per (y, z)
+ * with bit x set for solid blocks. Sections are filled in the first time a
+ * ray enters them, so a batch only pays for what it crosses. Missing chunks
+ * are remembered as null. Entries never move once created.
+ */
+class OccupancyCache {
+public:
+	struct Entry {
+		const Chunk* chunk = nullptr;
+		std::unique_ptr<uint16_t[]> rows;
+		uint64_t built = 0; // Bit per section whose rows are filled in
+	};
+
+private:
+	const ChunkMap& m_Chunks;
+	int m_Height;
+	std::unordered_map<uint64_t, Entry> m_Entries;
+	std::vector<BlockType> m_Scratch;
+
+public:
+	OccupancyCache(const ChunkMap& chunks, int height) : m_Chunks(chunks), m_Height(height), m_Scratch(SECTION_VOLUME) {}
+
+	Entry* Find(int x, int z) {
+		auto [it, inserted] = m_Entries.try_emplace(PackChunkKey(glm::ivec2(x, z)));
+		Entry& entry = it->second;
+		if (inserted) {
+			entry.chunk = m_Chunks.Find(glm::ivec2(x, z));
+			if (entry.chunk != nullptr) {
+				entry.rows.reset(new uint16_t[static_cast<size_t>(m_Height) * SECTION_SIZE]());
+			}
+		}
+
+		return &entry;
+	}
+
+	/* Fill in the rows of one section, y in chunk local blocks */
+	inline void Require(Entry& entry, int y) {
+		const int section = y >> CHUNK_SHIFT;
+		if (!((entry.built >> section) & 1)) {
+			Build(entry, section);
+		}
+	}
+
+	void Build(Entry& entry, int section) {
+		entry.built |= 1ull << section;
+		if (section >= entry.chunk->GetSectionCount()) {
+			return;
+		}
+
+		const PalettedContainer* blocks = entry.chunk->GetSection(section).GetBlocks();
+		if (blocks == nullptr) {
+			return;
+		}
+
+		/* Sections made only of solid or only of passable blocks need no decoding */
+		bool anySolid = false, allSolid = true;
+		for (BlockType type : blocks->GetPalette()) {
+			anySolid |= IsBlockSolid(type);
+			allSolid &= IsBlockSolid(type);
+		}
+
+		if (!anySolid) {
+			return;
+		}
+
+		uint16_t* rows = &entry.rows[static_cast<size_t>(section) * SECTION_SIZE * SECTION_SIZE];
+		if (allSolid) {
+			std::fill(rows, rows + SECTION_SIZE * SECTION_SIZE, UINT16_MAX);
+			return;
+		}
+
+		blocks->Decode(m_Scratch.data());
+		for (int y = 0; y < SECTION_SIZE; y++) {
+			for (int z = 0; z < SECTION_SIZE; z++) {
+				const BlockType* row = &m_Scratch[GetBlockIndex(0, y, z, SECTION_SIZE, SECTION_SIZE, SECTION_SIZE)];
+
+				uint16_t bits = 0;
+				for (int x = 0; x < SECTION_SIZE; x++) {
+					bits |= static_cast<uint16_t>(solidBlocks[static_cast<size_t>(row[x])]) << x;
+				}
+
+				rows[y * SECTION_SIZE + z] = bits;
+			}
+		}
+	}
+};
+
+/*
+ * Struct of arrays holding one ray per lane, so the step to the next cell
+ * runs on every lane at once. Idle lanes have infinite boundaries and never
+ * move. Checking a cell stays per lane, it needs a chunk lookup.
+ */
+template <int Width>
+struct RayLanes {
+	static constexpr int WIDTH = Width;
+
+	alignas(32) int32_t cell[3][Width];
+	alignas(32) int32_t step[3][Width];
+	alignas(32) float next[3][Width];
+	alignas(32) float delta[3][Width];
+	alignas(32) float travelled[Width];
+	alignas(32) int32_t axis[Width]; // Axis of the last boundary crossed, -1 at the origin
+
+	/* Cell in chunk terms, refreshed by every step */
+	alignas(32) int32_t chunkX[Width];
+	alignas(32) int32_t chunkZ[Width];
+	alignas(32) int32_t row[Width];
+	alignas(32) int32_t bit[Width];
+
+	/* Per lane bookkeeping */
+	glm::vec3 direction[Width];
+	float distance[Width];
+	size_t ray[Width];
+	bool active[Width];
+	bool chunkValid[Width];
+	int32_t cachedX[Width];
+	int32_t cachedZ[Width];
+	OccupancyCache::Entry* entry[Width];
+};
+
+template <int Width>
+static void UpdateChunkCoords(RayLanes<Width>& lanes, int lane) {
+	lanes.chunkX[lane] = lanes.cell[0][lane] >> CHUNK_SHIFT;
+	lanes.chunkZ[lane] = lanes.cell[2][lane] >> CHUNK_SHIFT;
+	lanes.row[lane] = lanes.cell[1][lane] * SECTION_SIZE + (lanes.cell[2][lane] & CHUNK_MASK);
+	lanes.bit[lane] = lanes.cell[0][lane] & CHUNK_MASK;
+}
+
+template <int Width>
+static void ClearLane(RayLanes<Width>& lanes, int lane) {
+	constexpr float infinity = std::numeric_limits<float>::infinity();
+	for (int axis = 0; axis < 3; axis++) {
+		lanes.cell[axis][lane] = 0;
+		lanes.step[axis][lane] = 0;
+		lanes.next[axis][lane] = infinity;
+		lanes.delta[axis][lane] = infinity;
+	}
+
+	lanes.travelled[lane] = 0.0f;
+	lanes.axis[lane] = -1;
+	lanes.active[lane] = false;
+	UpdateChunkCoords(lanes, lane);
+}
+
+template <int Width>
+static bool StartLane(RayLanes<Width>& lanes, int lane, const Ray& ray, size_t index) {
+	RayStart start;
+	if (!SetupRay(ray.origin, ray.direction, ray.distance, start)) {
+		return false;
+	}
+
+	for (int axis = 0; axis < 3; axis++) {
+		lanes.cell[axis][lane] = start.cell[axis];
+		lanes.step[axis][lane] = start.step[axis];
+		lanes.next[axis][lane] = start.next[axis];
+		lanes.delta[axis][lane] = start.delta[axis];
+	}
+
+	lanes.travelled[lane] = 0.0f;
+	lanes.axis[lane] = -1;
+	lanes.direction[lane] = start.direction;
+	lanes.distance[lane] = ray.distance;
+	lanes.ray[lane] = index;
+	lanes.active[lane] = true;
+	UpdateChunkCoords(lanes, lane);
+	return true;
+}
+
+/* Check the lane's current cell, true once the ray has hit or run out */
+template <int Width>
+static bool VisitCell(RayLanes<Width>& lanes, int lane, int height, OccupancyCache& cache, const std::vector<Ray>& rays, std::vector<RaycastResult>& results) {
+	const int y = lanes.cell[1][lane];
+	const int stepY = lanes.step[1][lane];
+
+	if (!(lanes.travelled[lane] <= lanes.distance[lane]) || (y < 0 && stepY <= 0) || (y >= height && stepY >= 0)) {
+		return true;
+	}
+
+	if (y < 0 || y >= height) {
+		return false;
+	}
+
+	/* Coherent rays stay in the same chunk for most steps */
+	if (!lanes.chunkValid[lane] || lanes.cachedX[lane] != lanes.chunkX[lane] || lanes.cachedZ[lane] != lanes.chunkZ[lane]) {
+		lanes.entry[lane] = cache.Find(lanes.chunkX[lane], lanes.chunkZ[lane]);
+		lanes.cachedX[lane] = lanes.chunkX[lane];
+		lanes.cachedZ[lane] = lanes.chunkZ[lane];
+		lanes.chunkValid[lane] = true;
+	}
+
+	OccupancyCache::Entry& entry = *lanes.entry[lane];
+	if (entry.chunk == nullptr) {
+		return false;
+	}
+
+	cache.Require(entry, y);
+	if (!((entry.rows[lanes.row[lane]] >> lanes.bit[lane]) & 1)) {
+		return false;
+	}
+
+	glm::ivec3 cell = glm::ivec3(lanes.cell[0][lane], lanes.cell[1][lane], lanes.cell[2][lane]);
+	glm::ivec3 normal = glm::ivec3(0);
+	if (lanes.axis[lane] >= 0) {
+		normal[lanes.axis[lane]] = -lanes.step[lanes.axis[lane]][lane];
+	}
+
+	BlockType type = entry.chunk->GetBlock(cell.x & CHUNK_MASK, cell.y, cell.z & CHUNK_MASK);
+	SetHit(results[lanes.ray[lane]], rays[lanes.ray[lane]].origin, lanes.direction[lane], lanes.travelled[lane], cell, normal, type);
+	return true;
+}
+
+/* Move every lane across its closest boundary, same choice as the single ray loop */
+#if defined(RAYCAST_AVX2)
+using BatchLanes = RayLanes<8>;
+
+static void StepLanes(BatchLanes& lanes) {
+	__m256 nx = _mm256_load_ps(lanes.next[0]);
+	__m256 ny = _mm256_load_ps(lanes.next[1]);
+	__m256 nz = _mm256_load_ps(lanes.next[2]);
+
+	__m256 xy = _mm256_cmp_ps(nx, ny, _CMP_LT_OQ);
+	__m256 xAxis = _mm256_and_ps(xy, _mm256_cmp_ps(nx, nz, _CMP_LT_OQ));
+	__m256 yAxis = _mm256_andnot_ps(xy, _mm256_cmp_ps(ny, nz, _CMP_LT_OQ));
+	__m256 zAxis = _mm256_andnot_ps(_mm256_or_ps(xAxis, yAxis), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+
+	_mm256_store_ps(lanes.travelled, _mm256_blendv_ps(_mm256_blendv_ps(nz, ny, yAxis), nx, xAxis));
+	_mm256_store_ps(lanes.next[0], _mm256_add_ps(nx, _mm256_and_ps(_mm256_load_ps(lanes.delta[0]), xAxis)));
+	_mm256_store_ps(lanes.next[1], _mm256_add_ps(ny, _mm256_and_ps(_mm256_load_ps(lanes.delta[1]), yAxis)));
+	_mm256_store_ps(lanes.next[2], _mm256_add_ps(nz, _mm256_and_ps(_mm256_load_ps(lanes.delta[2]), zAxis)));
+
+	const __m256i masks[3] = { _mm256_castps_si256(xAxis), _mm256_castps_si256(yAxis), _mm256_castps_si256(zAxis) };
+	__m256i cells[3];
+	for (int axis = 0; axis < 3; axis++) {
+		__m256i step = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.step[axis]));
+		cells[axis] = _mm256_add_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(lanes.cell[axis])), _mm256_and_si256(step, masks[axis]));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes.cell[axis]), cells[axis]);
+	}
+
+	/* Axis index is 0, 1 or 2 from the masks */
+	__m256i axis = _mm256_or_si256(_mm256_and_si256(masks[1], _mm256_set1_epi32(1)), _mm256_and_si256(masks[2], _mm256_set1_epi32(2)));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes.axis), axis);
+
+	const __m256i mask = _mm256_set1_epi32(CHUNK_MASK);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes.chunkX), _mm256_srai_epi32(cells[0], CHUNK_SHIFT));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes.chunkZ), _mm256_srai_epi32(cells[2], CHUNK_SHIFT));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes.row), _mm256_add_epi32(_mm256_slli_epi32(cells[1], CHUNK_SHIFT), _mm256_and_si256(cells[2], mask)));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(lanes.bit), _mm256_and_si256(cells[0], mask));
+}
+#elif defined(RAYCAST_SSE)
+using BatchLanes = RayLanes<4>;
+
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static void StepLanes(BatchLanes& lanes) {
+	__m128 nx = _mm_load_ps(lanes.next[0]);
+	__m128 ny = _mm_load_ps(lanes.next[1]);
+	__m128 nz = _mm_load_ps(lanes.next[2]);
+
+	__m128 xy = _mm_cmplt_ps(nx, ny);
+	__m128 xAxis = _mm_and_ps(xy, _mm_cmplt_ps(nx, nz));
+	__m128 yAxis = _mm_andnot_ps(xy, _mm_cmplt_ps(ny, nz));
+	__m128 zAxis = _mm_andnot_ps(_mm_or_ps(xAxis, yAxis), _mm_castsi128_ps(_mm_set1_epi32(-1)));
+
+	_mm_store_ps(lanes.travelled, Select(xAxis, nx, Select(yAxis, ny, nz)));
+	_mm_store_ps(lanes.next[0], _mm_add_ps(nx, _mm_and_ps(_mm_load_ps(lanes.delta[0]), xAxis)));
+	_mm_store_ps(lanes.next[1], _mm_add_ps(ny, _mm_and_ps(_mm_load_ps(lanes.delta[1]), yAxis)));
+	_mm_store_ps(lanes.next[2], _mm_add_ps(nz, _mm_and_ps(_mm_load_ps(lanes.delta[2]), zAxis)));
+
+	const __m128i masks[3] = { _mm_castps_si128(xAxis), _mm_castps_si128(yAxis), _mm_castps_si128(zAxis) };
+	__m128i cells[3];
+	for (int axis = 0; axis < 3; axis++) {
+		__m128i step = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes.step[axis]));
+		cells[axis] = _mm_add_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(lanes.cell[axis])), _mm_and_si128(step, masks[axis]));
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes.cell[axis]), cells[axis]);
+	}
+
+	/* Axis index is 0, 1 or 2 from the masks */
+	__m128i axis = _mm_or_si128(_mm_and_si128(masks[1], _mm_set1_epi32(1)), _mm_and_si128(masks[2], _mm_set1_epi32(2)));
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes.axis), axis);
+
+	const __m128i mask = _mm_set1_epi32(CHUNK_MASK);
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes.chunkX), _mm_srai_epi32(cells[0], CHUNK_SHIFT));
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes.chunkZ), _mm_srai_epi32(cells[2], CHUNK_SHIFT));
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes.row), _mm_add_epi32(_mm_slli_epi32(cells[1], CHUNK_SHIFT), _mm_and_si128(cells[2], mask)));
+	_mm_store_si128(reinterpret_cast<__m128i*>(lanes.bit), _mm_and_si128(cells[0], mask));
+}
+#else
+using BatchLanes = RayLanes<1>;
+
+static void StepLanes(BatchLanes& lanes) {
+	if (!lanes.active[0]) {
+		return;
+	}
+
+	const float nx = lanes.next[0][0];
+	const float ny = lanes.next[1][0];
+	const float nz = lanes.next[2][0];
+
+	int axis = nx < ny ? (nx < nz ? 0 : 2) : (ny < nz ? 1 : 2);
+	lanes.travelled[0] = lanes.next[axis][0];
+	lanes.next[axis][0] += lanes.delta[axis][0];
+	lanes.cell[axis][0] += lanes.step[axis][0];
+	lanes.axis[0] = axis;
+	UpdateChunkCoords(lanes, 0);
+}
+#endif
+
+size_t RaycastBatch(const WorldSettings& settings, const ChunkMap& chunks, const std::vector<Ray>& rays, std::vector<RaycastResult>& results) {
+	results.resize(rays.size());
+	for (RaycastResult& result : results) {
+		result.hit = false;
+	}
+
+	if (settings.chunk_width != SECTION_SIZE || settings.chunk_depth != SECTION_SIZE) {
+		return 0;
+	}
+
+	OccupancyCache cache(chunks, settings.chunk_height);
+	BatchLanes lanes;
+	for (int lane = 0; lane < BatchLanes::WIDTH; lane++) {
+		ClearLane(lanes, lane);
+		lanes.chunkValid[lane] = false;
+	}
+
+	size_t next = 0;
+	size_t hits = 0;
+
+	for (;;) {
+		bool running = false;
+
+		for (int lane = 0; lane < BatchLanes::WIDTH; lane++) {
+			for (;;) {
+				/* Refill idle lanes, skipping rays that can't go anywhere. The lane keeps its chunk */
+				if (!lanes.active[lane]) {
+					if (next == rays.size()) {
+						ClearLane(lanes, lane);
+						break;
+					}
+
+					size_t index = next++;
+					if (!StartLane(lanes, lane, rays[index], index)) {
+						continue;
+					}
+				}
+
+				if (!VisitCell(lanes, lane, settings.chunk_height, cache, rays, results)) {
+					break;
+				}
+
+				if (results[lanes.ray[lane]].hit) {
+					hits++;
+				}
+
+				lanes.active[lane] = false;
+			}
+
+			running |= lanes.active[lane];
+		}
+
+		if (!running) {
+			break;
+		}
+
+		StepLanes(lanes);
+	}
+
+	return hits;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "world.h"
+#include "chunks.h"
+
+struct Ray {
+	glm::vec3 origin;
+	glm::vec3 direction; // Doesn't need to be normalized
+	float distance;      // In blocks
+};
+
+struct RaycastResult {
+	glm::vec3 position;   // Where the ray enters the block
+	glm::ivec3 block;     // World cell that was hit
+	glm::ivec3 normal;    // Outward normal of the face that was hit, zero if the ray starts inside the block
+	glm::ivec3 placement; // Cell in front of that face, where a new block would go
+	float distance;       // Along the ray, in blocks
+	BlockType type;
+	bool hit;
+};
+
+/*
+ * Exact voxel traversal (Amanatides & Woo). The ray steps from cell to cell
+ * across whichever boundary is closest, so every cell it touches is visited
+ * once, including corners. The current chunk is kept while the ray stays in
+ * it, so the chunk map is only consulted when a boundary is crossed. Cells in
+ * missing chunks count as air. Direction doesn't need to be normalized,
+ * distance is in blocks.
+ */
+bool Raycast(const WorldSettings& settings, const ChunkMap& chunks, glm::vec3 position, glm::vec3 direction, float distance, RaycastResult& result);
+
+/*
+ * The same traversal for many rays at once, with identical results. Rays run
+ * in SIMD lanes, eight with AVX2 or four with SSE2, or one at a time without
+ * either, and a finished lane picks up the next ray right away. Solid blocks
+ * are tested against one bit per block, built once per section the batch
+ * crosses, and each lane keeps its chunk between rays, so rays next to each
+ * other in the batch share chunk lookups.
+ * Results are resized to match the rays; returns the number of hits.
+ */
+size_t RaycastBatch(const WorldSettings& settings, const ChunkMap& chunks, const std::vector<Ray>& rays, std::vector<RaycastResult>& results);
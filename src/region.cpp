@@ -0,0 +1,443 @@
+#include "region.h"
+#include "codec.h"
+
+#include <string>
+#include <cstring>
+#include <iostream>
+
+#ifdef REGION_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* Payload header, codec followed by the uncompressed size */
+constexpr size_t PAYLOAD_HEADER_SIZE = 5;
+
+static uint32_t ReadU32(const unsigned char* bytes) {
+	return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+		static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+static void WriteU32(unsigned char* bytes, uint32_t value) {
+	bytes[0] = static_cast<unsigned char>(value);
+	bytes[1] = static_cast<unsigned char>(value >> 8);
+	bytes[2] = static_cast<unsigned char>(value >> 16);
+	bytes[3] = static_cast<unsigned char>(value >> 24);
+}
+
+static uint32_t GetSectorCount(size_t bytes) {
+	return static_cast<uint32_t>((bytes + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE);
+}
+
+/* Compress blocks into a payload */
+static void EncodeChunk(const std::vector<BlockType>& blocks, const WorldSettings& settings, std::vector<unsigned char>& payload) {
+	payload.assign(PAYLOAD_HEADER_SIZE, 0);
+	payload[0] = static_cast<unsigned char>(RegionCodec::BLOCKS);
+	WriteU32(payload.data() + 1, static_cast<uint32_t>(blocks.size()));
+	CompressBlocks(blocks.data(), settings.chunk_width, settings.chunk_height, settings.chunk_depth, payload);
+}
+
+/* Decompress a payload, false if it's damaged or doesn't hold a chunk of the world's size */
+static bool DecodeChunk(const std::vector<unsigned char>& payload, const WorldSettings& settings, std::vector<BlockType>& blocks) {
+	const size_t size = static_cast<size_t>(settings.chunk_width) * settings.chunk_height * settings.chunk_depth;
+	if (payload.size() < PAYLOAD_HEADER_SIZE || ReadU32(payload.data() + 1) != size) {
+		return false;
+	}
+
+	if (payload[0] == static_cast<unsigned char>(RegionCodec::BLOCKS)) {
+		blocks.resize(size);
+		return DecompressBlocks(
+			payload.data() + PAYLOAD_HEADER_SIZE, payload.size() - PAYLOAD_HEADER_SIZE,
+			settings.chunk_width, settings.chunk_height, settings.chunk_depth, blocks.data()
+		);
+	}
+
+	/* Chunks written before the block codec */
+	if (payload[0] != static_cast<unsigned char>(RegionCodec::RLE)) {
+		return false;
+	}
+
+	blocks.clear();
+	blocks.reserve(size);
+	for (size_t i = PAYLOAD_HEADER_SIZE; i + 1 < payload.size(); i += 2) {
+		const size_t run = payload[i];
+		if (run == 0 || blocks.size() + run > size || payload[i + 1] >= BLOCK_TYPE_COUNT) {
+			return false;
+		}
+
+		blocks.insert(blocks.end(), run, static_cast<BlockType>(payload[i + 1]));
+	}
+
+	return blocks.size() == size;
+}
+
+RegionFile::RegionFile(const std::filesystem::path& path) : m_Path(path), m_Entries{} {
+#ifdef REGION_MMAP
+	m_Descriptor = -1;
+	m_Mapping = nullptr;
+	m_MappedSize = 0;
+#endif
+
+	std::error_code error;
+	size_t size = std::filesystem::exists(path, error) ? static_cast<size_t>(std::filesystem::file_size(path, error)) : 0;
+	if (error) {
+		size = 0;
+	}
+
+	/* A file too short to hold the table is started over */
+	if (size < REGION_HEADER_SIZE) {
+		if (size != 0) {
+			std::cerr << "Region file " << path << " is truncated, starting it over" << std::endl;
+		}
+
+		std::ofstream create(path, std::ios::binary | std::ios::trunc);
+		const std::vector<char> header(REGION_HEADER_SIZE, 0);
+		create.write(header.data(), header.size());
+		size = REGION_HEADER_SIZE;
+	}
+
+	m_Stream.open(path, std::ios::in | std::ios::out | std::ios::binary);
+	if (!m_Stream.is_open()) {
+		std::cerr << "Failed to open region file " << path << std::endl;
+		return;
+	}
+
+	unsigned char header[REGION_HEADER_SIZE];
+	m_Stream.read(reinterpret_cast<char*>(header), REGION_HEADER_SIZE);
+	if (!m_Stream) {
+		std::cerr << "Failed to read region file " << path << std::endl;
+		m_Stream.close();
+		return;
+	}
+
+	const uint32_t sectors = GetSectorCount(size);
+	m_UsedSectors.assign(sectors, false);
+	MarkSectors(0, REGION_HEADER_SECTORS, true);
+
+	for (int i = 0; i < REGION_CHUNK_COUNT; i++) {
+		Entry entry = { ReadU32(header + i * 8), ReadU32(header + i * 8 + 4) };
+		if (entry.sector == 0) {
+			continue;
+		}
+
+		/* Entries pointing into the table or past the end are dropped, the chunk is generated again */
+		if (entry.sector < REGION_HEADER_SECTORS || entry.sector + GetSectorCount(entry.size) > sectors) {
+			std::cerr << "Region file " << path << " has a damaged entry for chunk " << i << ", ignoring it" << std::endl;
+			continue;
+		}
+
+		m_Entries[i] = entry;
+		MarkSectors(entry.sector, GetSectorCount(entry.size), true);
+	}
+
+#ifdef REGION_MMAP
+	m_Descriptor = open(path.c_str(), O_RDONLY);
+	Remap();
+#endif
+}
+
+RegionFile::~RegionFile() {
+#ifdef REGION_MMAP
+	if (m_Mapping != nullptr) {
+		munmap(const_cast<unsigned char*>(m_Mapping), m_MappedSize);
+	}
+
+	if (m_Descriptor != -1) {
+		close(m_Descriptor);
+	}
+#endif
+}
+
+#ifdef REGION_MMAP
+bool RegionFile::Remap() {
+	if (m_Descriptor == -1) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(m_Descriptor, &info) != 0) {
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(info.st_size);
+	if (m_Mapping != nullptr && size == m_MappedSize) {
+		return true;
+	}
+
+	if (m_Mapping != nullptr) {
+		munmap(const_cast<unsigned char*>(m_Mapping), m_MappedSize);
+		m_Mapping = nullptr;
+		m_MappedSize = 0;
+	}
+
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, m_Descriptor, 0);
+	if (mapping == MAP_FAILED) {
+		return false;
+	}
+
+	m_Mapping = static_cast<const unsigned char*>(mapping);
+	m_MappedSize = size;
+	return true;
+}
+#endif
+
+void RegionFile::MarkSectors(uint32_t first, uint32_t count, bool used) {
+	if (first + count > m_UsedSectors.size()) {
+		m_UsedSectors.resize(first + count, false);
+	}
+
+	for (uint32_t i = first; i < first + count; i++) {
+		m_UsedSectors[i] = used;
+	}
+}
+
+uint32_t RegionFile::AllocateSectors(uint32_t count) {
+	/* First run of free sectors long enough, or the end of the file */
+	uint32_t run = 0;
+	for (uint32_t i = REGION_HEADER_SECTORS; i < m_UsedSectors.size(); i++) {
+		run = m_UsedSectors[i] ? 0 : run + 1;
+		if (run == count) {
+			return i + 1 - count;
+		}
+	}
+
+	return static_cast<uint32_t>(m_UsedSectors.size()) - run;
+}
+
+bool RegionFile::Read(int index, std::vector<unsigned char>& payload) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	const Entry& entry = m_Entries[index];
+	if (entry.sector == 0 || !m_Stream.is_open()) {
+		return false;
+	}
+
+	const size_t offset = static_cast<size_t>(entry.sector) * REGION_SECTOR_SIZE;
+	const size_t end = offset + entry.size;
+
+#ifdef REGION_MMAP
+	if ((m_Mapping != nullptr && end <= m_MappedSize) || (Remap() && end <= m_MappedSize)) {
+		payload.assign(m_Mapping + offset, m_Mapping + end);
+		return true;
+	}
+#endif
+
+	payload.resize(entry.size);
+	m_Stream.clear();
+	m_Stream.seekg(offset);
+	m_Stream.read(reinterpret_cast<char*>(payload.data()), entry.size);
+	return static_cast<bool>(m_Stream);
+}
+
+bool RegionFile::Write(int index, const std::vector<unsigned char>& payload) {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	if (!m_Stream.is_open()) {
+		return false;
+	}
+
+	Entry& entry = m_Entries[index];
+	const uint32_t count = GetSectorCount(payload.size());
+	const uint32_t current = entry.sector != 0 ? GetSectorCount(entry.size) : 0;
+
+	/* Allocate before freeing the old sectors, so the old payload is intact until the table moves */
+	uint32_t sector = entry.sector;
+	if (count > current) {
+		sector = AllocateSectors(count);
+		MarkSectors(sector, count, true);
+	}
+
+	std::vector<char> padded(static_cast<size_t>(count) * REGION_SECTOR_SIZE, 0);
+	std::memcpy(padded.data(), payload.data(), payload.size());
+
+	m_Stream.clear();
+	m_Stream.seekp(static_cast<std::streamoff>(sector) * REGION_SECTOR_SIZE);
+	m_Stream.write(padded.data(), padded.size());
+
+	unsigned char table[8];
+	WriteU32(table, sector);
+	WriteU32(table + 4, static_cast<uint32_t>(payload.size()));
+	m_Stream.seekp(static_cast<std::streamoff>(index) * 8);
+	m_Stream.write(reinterpret_cast<char*>(table), sizeof(table));
+	m_Stream.flush();
+
+	if (!m_Stream) {
+		std::cerr << "Failed to write region file " << m_Path << std::endl;
+		return false;
+	}
+
+	/* Release whatever the chunk used before and no longer needs */
+	if (sector != entry.sector) {
+		MarkSectors(entry.sector, current, false);
+	} else if (count < current) {
+		MarkSectors(sector + count, current - count, false);
+	}
+
+	entry = { sector, static_cast<uint32_t>(payload.size()) };
+	return true;
+}
+
+ChunkStorage::ChunkStorage(const std::filesystem::path& directory, const WorldSettings& settings)
+	: m_Directory(directory), m_Settings(settings), m_IsWriting(false), m_Stopping(false), m_Loads(0), m_Saves(0), m_Bytes(0) {
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		std::cerr << "Failed to create the world directory " << directory << ": " << error.message() << std::endl;
+	}
+
+	m_Writer = std::thread(&ChunkStorage::WriterLoop, this);
+}
+
+ChunkStorage::~ChunkStorage() {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+
+	/* The writer drains the queue before it stops */
+	m_Condition.notify_all();
+	m_Writer.join();
+}
+
+RegionFile* ChunkStorage::GetRegion(glm::ivec2 region, bool create) {
+	std::lock_guard<std::mutex> lock(m_RegionMutex);
+
+	auto it = m_Regions.find(PackChunkKey(region));
+	if (it != m_Regions.end()) {
+		return it->second.get();
+	}
+
+	const std::filesystem::path path = m_Directory / ("r." + std::to_string(region.x) + "." + std::to_string(region.y) + ".region");
+	std::error_code error;
+	if (!create && !std::filesystem::exists(path, error)) {
+		return nullptr;
+	}
+
+	auto file = std::make_unique<RegionFile>(path);
+	if (!file->IsOpen()) {
+		return nullptr;
+	}
+
+	return m_Regions.emplace(PackChunkKey(region), std::move(file)).first->second.get();
+}
+
+bool ChunkStorage::Load(glm::ivec2 position, std::vector<BlockType>& blocks) {
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto pending = m_Pending.find(PackChunkKey(position));
+		if (pending != m_Pending.end()) {
+			blocks = pending->second.blocks;
+			m_Loads++;
+			return true;
+		}
+
+		if (m_IsWriting && m_Writing.position == position) {
+			blocks = m_Writing.blocks;
+			m_Loads++;
+			return true;
+		}
+	}
+
+	RegionFile* region = GetRegion({ position.x >> REGION_SHIFT, position.y >> REGION_SHIFT }, false);
+	if (region == nullptr) {
+		return false;
+	}
+
+	std::vector<unsigned char> payload;
+	const int index = (position.x & (REGION_SIZE - 1)) + (position.y & (REGION_SIZE - 1)) * REGION_SIZE;
+	if (!region->Read(index, payload)) {
+		return false;
+	}
+
+	if (!DecodeChunk(payload, m_Settings, blocks)) {
+		std::cerr << "Chunk (" << position.x << ", " << position.y << ") on disk is damaged or a different size, generating it again" << std::endl;
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Loads++;
+	return true;
+}
+
+void ChunkStorage::Save(const Chunk& chunk) {
+	PendingChunk pending{ chunk.GetPosition(), {} };
+	chunk.Decode(pending.blocks);
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		/* A chunk saved again before it was written only needs writing once */
+		auto it = m_Pending.find(PackChunkKey(pending.position));
+		if (it != m_Pending.end()) {
+			it->second = std::move(pending);
+			return;
+		}
+
+		m_Order.push_back(pending.position);
+		m_Pending.emplace(PackChunkKey(pending.position), std::move(pending));
+	}
+
+	m_Condition.notify_one();
+}
+
+void ChunkStorage::Flush() {
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_IdleCondition.wait(lock, [this] { return m_Order.empty() && !m_IsWriting; });
+}
+
+void ChunkStorage::WriterLoop() {
+	std::vector<unsigned char> payload;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Condition.wait(lock, [this] { return m_Stopping || !m_Order.empty(); });
+
+			if (m_Order.empty()) {
+				return;
+			}
+
+			auto it = m_Pending.find(PackChunkKey(m_Order.front()));
+			m_Order.pop_front();
+
+			m_Writing = std::move(it->second);
+			m_Pending.erase(it);
+			m_IsWriting = true;
+		}
+
+		/* Loads only read m_Writing, so it can be compressed without the lock */
+		EncodeChunk(m_Writing.blocks, m_Settings, payload);
+
+		const glm::ivec2 position = m_Writing.position;
+		const int index = (position.x & (REGION_SIZE - 1)) + (position.y & (REGION_SIZE - 1)) * REGION_SIZE;
+		RegionFile* region = GetRegion({ position.x >> REGION_SHIFT, position.y >> REGION_SHIFT }, true);
+		const bool written = region != nullptr && region->Write(index, payload);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsWriting = false;
+			m_Writing.blocks.clear();
+
+			if (written) {
+				m_Saves++;
+				m_Bytes += payload.size();
+			}
+		}
+
+		m_IdleCondition.notify_all();
+	}
+}
+
+StorageStats ChunkStorage::GetStats() const {
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	StorageStats stats;
+	stats.loads = m_Loads;
+	stats.saves = m_Saves;
+	stats.pending = m_Pending.size() + (m_IsWriting ? 1 : 0);
+	stats.bytes = m_Bytes;
+	return stats;
+}
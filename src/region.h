@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include <condition_variable>
+
+#include <glm/glm.hpp>
+
+#include "world.h"
+#include "chunks.h"
+
+/* Read region files through a memory mapping where the platform has mmap */
+#if defined(__unix__) || defined(__APPLE__)
+#define REGION_MMAP
+#endif
+
+/* Chunks per region side, a region covers REGION_SIZE by REGION_SIZE chunks */
+constexpr int REGION_SHIFT = 5;
+constexpr int REGION_SIZE = 1 << REGION_SHIFT;
+constexpr int REGION_CHUNK_COUNT = REGION_SIZE * REGION_SIZE;
+
+/* Payloads start on sector boundaries, the header takes the first sectors */
+constexpr size_t REGION_SECTOR_SIZE = 4096;
+constexpr size_t REGION_HEADER_SIZE = REGION_CHUNK_COUNT * 8;
+constexpr uint32_t REGION_HEADER_SECTORS = static_cast<uint32_t>(REGION_HEADER_SIZE / REGION_SECTOR_SIZE);
+
+/* How a payload's blocks are compressed, stored in its first byte */
+enum class RegionCodec : uint8_t {
+	RLE = 1,    // Runs of (count, block) byte pairs, only read
+	BLOCKS = 2, // CompressBlocks
+};
+
+/*
+ * One region file. It starts with a fixed table holding an entry per chunk,
+ * x fastest, of the sector the chunk's payload starts at and the payload's
+ * size in bytes, both 32 bit little endian and zero for chunks that were
+ * never written. Payloads are padded to whole sectors. A rewritten payload
+ * stays where it was if it still fits, otherwise it moves to the first run
+ * of free sectors or the end of the file; it's always written before the
+ * table entry that points at it.
+ *
+ * Reads go through a read only mapping of the file where mmap exists, and
+ * through the file stream elsewhere or if mapping fails. Every call locks
+ * the file, so the writer thread and the workers can share it.
+ */
+class RegionFile {
+private:
+	struct Entry {
+		uint32_t sector;
+		uint32_t size;
+	};
+
+	std::filesystem::path m_Path;
+	std::fstream m_Stream;
+	std::array<Entry, REGION_CHUNK_COUNT> m_Entries;
+	std::vector<bool> m_UsedSectors; // One per sector in the file, header included
+	std::mutex m_Mutex;
+
+#ifdef REGION_MMAP
+	int m_Descriptor;
+	const unsigned char* m_Mapping;
+	size_t m_MappedSize;
+
+	/* Map the file again if it grew since it was last mapped */
+	bool Remap();
+#endif
+
+	uint32_t AllocateSectors(uint32_t count);
+	void MarkSectors(uint32_t first, uint32_t count, bool used);
+
+public:
+	/* Opens the file, creating it with an empty table if it doesn't exist */
+	RegionFile(const std::filesystem::path& path);
+	~RegionFile();
+
+	/* Delete copying */
+	RegionFile(const RegionFile&) = delete;
+	RegionFile& operator=(const RegionFile&) = delete;
+
+	/* Index is the chunk's position inside the region, x + z * REGION_SIZE */
+	bool Read(int index, std::vector<unsigned char>& payload);
+	bool Write(int index, const std::vector<unsigned char>& payload);
+
+	inline bool IsOpen() const { return m_Stream.is_open(); }
+};
+
+struct StorageStats {
+	size_t loads = 0;   // Chunks read back, since start
+	size_t saves = 0;   // Chunks written to disk, since start
+	size_t pending = 0; // Chunks waiting for the writer
+	size_t bytes = 0;   // Compressed bytes written, since start
+};
+
+/*
+ * Chunks kept in region files in a directory, named r.<x>.<z>.region after
+ * the region's position. Save takes a copy of the chunk's blocks and returns
+ * right away, a writer thread compresses and writes them in the order they
+ * were saved. Load can be called from any thread; chunks the writer hasn't
+ * got to yet are served from memory, so a chunk loaded right after it was
+ * saved comes back the way it was saved. Everything saved is on disk once
+ * Flush returns or the storage is destroyed.
+ */
+class ChunkStorage {
+private:
+	struct PendingChunk {
+		glm::ivec2 position;
+		std::vector<BlockType> blocks;
+	};
+
+	std::filesystem::path m_Directory;
+	WorldSettings m_Settings;
+
+	/* Open regions, created the first time a chunk in them is written */
+	std::mutex m_RegionMutex;
+	std::unordered_map<uint64_t, std::unique_ptr<RegionFile>> m_Regions;
+
+	/* Chunks saved but not written yet, newest copy per position */
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Condition;     // Wakes the writer
+	std::condition_variable m_IdleCondition; // Wakes Flush
+	std::unordered_map<uint64_t, PendingChunk> m_Pending;
+	std::deque<glm::ivec2> m_Order;
+	PendingChunk m_Writing;                  // Taken out of m_Pending while it's written
+	bool m_IsWriting;
+	bool m_Stopping;
+	size_t m_Loads;
+	size_t m_Saves;
+	size_t m_Bytes;
+
+	std::thread m_Writer;
+
+	/* Null if the region has no file and create isn't set */
+	RegionFile* GetRegion(glm::ivec2 region, bool create);
+	void WriterLoop();
+
+public:
+	ChunkStorage(const std::filesystem::path& directory, const WorldSettings& settings);
+	~ChunkStorage();
+
+	/* Delete copying */
+	ChunkStorage(const ChunkStorage&) = delete;
+	ChunkStorage& operator=(const ChunkStorage&) = delete;
+
+	/* Any thread, fills blocks in the layout the Chunk constructor takes, false if the chunk was never saved */
+	bool Load(glm::ivec2 position, std::vector<BlockType>& blocks);
+
+	/* Queue writing a chunk's blocks, replacing any copy still waiting */
+	void Save(const Chunk& chunk);
+
+	/* Wait until everything saved so far is on disk */
+	void Flush();
+
+	StorageStats GetStats() const;
+};
@@ -0,0 +1,95 @@
+#include "allocator.h"
+
+#include <iterator>
+#include <iostream>
+#include <algorithm>
+
+namespace render {
+	RangeAllocator::RangeAllocator(size_t capacity) : m_Capacity(0), m_Used(0) {
+		Reset(capacity);
+	}
+
+	size_t RangeAllocator::Allocate(size_t size) {
+		if (size == 0) {
+			return 0;
+		}
+
+		/* Best fit keeps large blocks around for large meshes */
+		auto best = m_Free.end();
+		for (auto it = m_Free.begin(); it != m_Free.end(); ++it) {
+			if (it->second >= size && (best == m_Free.end() || it->second < best->second)) {
+				best = it;
+
+				if (best->second == size) {
+					break;
+				}
+			}
+		}
+
+		if (best == m_Free.end()) {
+			return INVALID_OFFSET;
+		}
+
+		/* Take the front of the block, the rest stays free */
+		size_t offset = best->first;
+		size_t remaining = best->second - size;
+		m_Free.erase(best);
+
+		if (remaining > 0) {
+			m_Free.emplace(offset + size, remaining);
+		}
+
+		m_Used += size;
+		return offset;
+	}
+
+	void RangeAllocator::Free(size_t offset, size_t size) {
+		if (size == 0) {
+			return;
+		}
+
+		if (offset + size > m_Capacity) {
+			std::cerr << "Attempted to free a range outside the allocator" << std::endl;
+			return;
+		}
+
+		m_Used -= size;
+
+		/* Merge with the following block */
+		auto next = m_Free.lower_bound(offset);
+		if (next != m_Free.end() && offset + size == next->first) {
+			size += next->second;
+			next = m_Free.erase(next);
+		}
+
+		/* Merge with the preceding block */
+		if (next != m_Free.begin()) {
+			auto previous = std::prev(next);
+			if (previous->first + previous->second == offset) {
+				previous->second += size;
+				return;
+			}
+		}
+
+		m_Free.emplace(offset, size);
+	}
+
+	void RangeAllocator::Reset(size_t capacity) {
+		m_Capacity = capacity;
+		m_Used = 0;
+		m_Free.clear();
+
+		if (capacity > 0) {
+			m_Free.emplace(0, capacity);
+		}
+	}
+
+	size_t RangeAllocator::GetLargestFreeBlock() const {
+		size_t largest = 0;
+		for (const auto& [offset, size] : m_Free) {
+			largest = std::max(largest, size);
+		}
+
+		return largest;
+	}
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <map>
+#include <cstddef>
+#include <cstdint>
+
+namespace render {
+	/*
+	 * Free list suballocator over the units [0, capacity), used to carve
+	 * ranges out of large GPU buffers. Free blocks are kept sorted by offset
+	 * and merged with their neighbours on release, allocation is best fit.
+	 * The allocator never touches the memory it manages.
+	 */
+	class RangeAllocator {
+	private:
+		size_t m_Capacity;
+		size_t m_Used;
+		std::map<size_t, size_t> m_Free; // Offset to size
+
+	public:
+		static constexpr size_t INVALID_OFFSET = SIZE_MAX;
+
+		RangeAllocator(size_t capacity = 0);
+
+		/* Returns INVALID_OFFSET if no single free block fits */
+		size_t Allocate(size_t size);
+		void Free(size_t offset, size_t size);
+
+		/* Forget every allocation */
+		void Reset(size_t capacity);
+
+		/* Getters */
+		inline size_t GetCapacity() const { return m_Capacity; }
+		inline size_t GetUsed() const { return m_Used; }
+		inline size_t GetFree() const { return m_Capacity - m_Used; }
+		inline size_t GetFreeBlockCount() const { return m_Free.size(); }
+		size_t GetLargestFreeBlock() const;
+	};
+};
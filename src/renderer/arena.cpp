@@ -0,0 +1,286 @@
+#include "arena.h"
+#include "state.h"
+
+#include <iostream>
+#include <algorithm>
+
+namespace render {
+	/* Draws the instance and indirect buffers start out with room for */
+	constexpr size_t INITIAL_DRAW_CAPACITY = 256;
+
+	ArenaAllocation::~ArenaAllocation() {
+		Reset();
+	}
+
+	ArenaAllocation::ArenaAllocation(ArenaAllocation&& other) noexcept : m_Arena(other.m_Arena), m_ID(other.m_ID) {
+		other.m_Arena = nullptr;
+	}
+
+	ArenaAllocation& ArenaAllocation::operator=(ArenaAllocation&& other) noexcept {
+		if (this != &other) {
+			Reset();
+
+			m_Arena = other.m_Arena;
+			m_ID = other.m_ID;
+			other.m_Arena = nullptr;
+		}
+
+		return *this;
+	}
+
+	void ArenaAllocation::Reset() {
+		if (m_Arena != nullptr) {
+			m_Arena->Release(m_ID);
+			m_Arena = nullptr;
+		}
+	}
+
+	static void CopyBuffer(unsigned int source, unsigned int destination, size_t sourceOffset, size_t destinationOffset, size_t size) {
+		StateCache::Get().BindBuffer(GL_COPY_READ_BUFFER, source);
+		StateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, destination);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size);
+	}
+
+	GeometryArena::GeometryArena(const VertexBufferLayout& vertexLayout, const VertexBufferLayout& instanceLayout, size_t vertexCapacity, size_t indexCapacity, size_t stagingSize) :
+		m_VertexLayout(vertexLayout),
+		m_InstanceLayout(instanceLayout),
+		m_VAO(),
+		m_VBO(nullptr, vertexCapacity * vertexLayout.GetStride(), BufferHint::STATIC_DRAW),
+		m_EBO(nullptr, indexCapacity, BufferHint::STATIC_DRAW),
+		m_Vertices(vertexCapacity),
+		m_Indices(indexCapacity),
+		m_Staging(stagingSize),
+		m_Relocations(0),
+		m_InstanceVBO(nullptr, INITIAL_DRAW_CAPACITY * instanceLayout.GetStride(), BufferHint::DYNAMIC_DRAW),
+		m_IndirectBuffer(nullptr, INITIAL_DRAW_CAPACITY * sizeof(DrawElementsIndirectCommand), BufferHint::DYNAMIC_DRAW),
+		m_InstanceCapacity(INITIAL_DRAW_CAPACITY),
+		m_CommandCapacity(INITIAL_DRAW_CAPACITY),
+		m_DrawCalls(0)
+	{
+		AttachBuffers();
+		AttachInstances();
+	}
+
+	void GeometryArena::AttachBuffers() {
+		/* The element buffer binding is vertex array state */
+		m_VAO.AddBuffer(m_VBO, m_VertexLayout);
+		m_EBO.Bind();
+	}
+
+	void GeometryArena::AttachInstances() {
+		if (m_InstanceLayout.GetStride() == 0) {
+			return;
+		}
+
+		/* Instance attributes follow the vertex attributes and advance once per draw */
+		m_VAO.AddBuffer(m_InstanceVBO, m_InstanceLayout, static_cast<unsigned int>(m_VertexLayout.GetElements().size()), 1);
+	}
+
+	ArenaAllocation GeometryArena::Allocate(const void* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount) {
+		size_t vertexOffset = m_Vertices.Allocate(vertexCount);
+		size_t indexOffset = m_Indices.Allocate(indexCount);
+
+		if (vertexOffset == RangeAllocator::INVALID_OFFSET || indexOffset == RangeAllocator::INVALID_OFFSET) {
+			if (vertexOffset != RangeAllocator::INVALID_OFFSET) {
+				m_Vertices.Free(vertexOffset, vertexCount);
+			}
+
+			if (indexOffset != RangeAllocator::INVALID_OFFSET) {
+				m_Indices.Free(indexOffset, indexCount);
+			}
+
+			/* Compacting is enough if the space is only fragmented, otherwise grow */
+			size_t vertexCapacity = std::max<size_t>(m_Vertices.GetCapacity(), 1);
+			while (vertexCapacity - m_Vertices.GetUsed() < vertexCount) {
+				vertexCapacity *= 2;
+			}
+
+			size_t indexCapacity = std::max<size_t>(m_Indices.GetCapacity(), 1);
+			while (indexCapacity - m_Indices.GetUsed() < indexCount) {
+				indexCapacity *= 2;
+			}
+
+			Relocate(vertexCapacity, indexCapacity);
+
+			/* Free space is a single block after relocating */
+			vertexOffset = m_Vertices.Allocate(vertexCount);
+			indexOffset = m_Indices.Allocate(indexCount);
+		}
+
+		/* Copies go through the copy targets, so no vertex array's element binding changes */
+		const size_t stride = m_VertexLayout.GetStride();
+		m_Staging.Upload(m_VBO.GetRendererID(), vertexOffset * stride, vertices, vertexCount * stride);
+		m_Staging.Upload(m_EBO.GetRendererID(), indexOffset * sizeof(unsigned int), indices, indexCount * sizeof(unsigned int));
+
+		/* Reuse a released slot if possible */
+		uint32_t id;
+		if (!m_FreeRanges.empty()) {
+			id = m_FreeRanges.back();
+			m_FreeRanges.pop_back();
+		} else {
+			id = static_cast<uint32_t>(m_Ranges.size());
+			m_Ranges.emplace_back();
+		}
+
+		m_Ranges[id] = { vertexOffset, vertexCount, indexOffset, indexCount, true };
+		return ArenaAllocation(this, id);
+	}
+
+	void GeometryArena::Release(uint32_t id) {
+		Range& range = m_Ranges[id];
+		m_Vertices.Free(range.vertexOffset, range.vertexCount);
+		m_Indices.Free(range.indexOffset, range.indexCount);
+
+		range.live = false;
+		m_FreeRanges.push_back(id);
+	}
+
+	void GeometryArena::Relocate(size_t vertexCapacity, size_t indexCapacity) {
+		const size_t stride = m_VertexLayout.GetStride();
+
+		/* Overlapping copies within one buffer aren't allowed, so pack into new ones */
+		m_VAO.Bind();
+		VertexBuffer vbo(nullptr, vertexCapacity * stride, BufferHint::STATIC_DRAW);
+		ElementBuffer ebo(nullptr, indexCapacity, BufferHint::STATIC_DRAW);
+
+		m_Vertices.Reset(vertexCapacity);
+		m_Indices.Reset(indexCapacity);
+
+		for (Range& range : m_Ranges) {
+			if (!range.live) {
+				continue;
+			}
+
+			size_t vertexOffset = m_Vertices.Allocate(range.vertexCount);
+			size_t indexOffset = m_Indices.Allocate(range.indexCount);
+
+			if (range.vertexCount > 0) {
+				CopyBuffer(m_VBO.GetRendererID(), vbo.GetRendererID(), range.vertexOffset * stride, vertexOffset * stride, range.vertexCount * stride);
+			}
+
+			if (range.indexCount > 0) {
+				CopyBuffer(m_EBO.GetRendererID(), ebo.GetRendererID(), range.indexOffset * sizeof(unsigned int), indexOffset * sizeof(unsigned int), range.indexCount * sizeof(unsigned int));
+			}
+
+			range.vertexOffset = vertexOffset;
+			range.indexOffset = indexOffset;
+		}
+
+		m_VBO = std::move(vbo);
+		m_EBO = std::move(ebo);
+		AttachBuffers();
+
+		m_Relocations++;
+	}
+
+	void GeometryArena::Defragment() {
+		Relocate(m_Vertices.GetCapacity(), m_Indices.GetCapacity());
+	}
+
+	void GeometryArena::ClearDraws() {
+		m_Commands.clear();
+		m_InstanceData.clear();
+	}
+
+	void GeometryArena::AddDraw(const ArenaAllocation& allocation, const void* instance, size_t size) {
+		if (!allocation.IsValid()) {
+			return;
+		}
+
+		if (size != m_InstanceLayout.GetStride()) {
+			std::cerr << "Instance data doesn't match the arena's instance layout" << std::endl;
+			return;
+		}
+
+		const Range& range = m_Ranges[allocation.GetID()];
+		if (range.indexCount == 0) {
+			return;
+		}
+
+		/* Base instance selects this draw's instance data */
+		m_Commands.push_back({
+			static_cast<unsigned int>(range.indexCount),
+			1,
+			static_cast<unsigned int>(range.indexOffset),
+			static_cast<int>(range.vertexOffset),
+			static_cast<unsigned int>(m_Commands.size())
+		});
+
+		const unsigned char* bytes = static_cast<const unsigned char*>(instance);
+		m_InstanceData.insert(m_InstanceData.end(), bytes, bytes + size);
+	}
+
+	void GeometryArena::Draw() {
+		/* Staging space of everything uploaded since the last frame is free once this fence signals */
+		m_Staging.Fence();
+
+		m_DrawCalls = 0;
+		if (m_Commands.empty()) {
+			return;
+		}
+
+		m_VAO.Bind();
+
+		/* Upload per draw data, growing the buffer if needed */
+		const size_t stride = m_InstanceLayout.GetStride();
+		if (stride > 0) {
+			if (m_Commands.size() > m_InstanceCapacity) {
+				m_InstanceCapacity = std::max(m_InstanceCapacity * 2, m_Commands.size());
+				m_InstanceVBO = VertexBuffer(nullptr, m_InstanceCapacity * stride, BufferHint::DYNAMIC_DRAW);
+				AttachInstances();
+			}
+
+			m_InstanceVBO.SetSubData(m_InstanceData.data(), m_InstanceData.size(), 0);
+		}
+
+		if (HasMultiDrawIndirect()) {
+			if (m_Commands.size() > m_CommandCapacity) {
+				m_CommandCapacity = std::max(m_CommandCapacity * 2, m_Commands.size());
+				m_IndirectBuffer = IndirectBuffer(nullptr, m_CommandCapacity * sizeof(DrawElementsIndirectCommand), BufferHint::DYNAMIC_DRAW);
+			}
+
+			/* Everything in one call */
+			m_IndirectBuffer.SetData(m_Commands.data(), m_Commands.size() * sizeof(DrawElementsIndirectCommand));
+			MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(m_Commands.size()), 0);
+			m_DrawCalls = 1;
+		} else {
+			/* Same commands, one call each */
+			for (const auto& command : m_Commands) {
+				glDrawElementsInstancedBaseVertexBaseInstance(
+					GL_TRIANGLES, command.count, GL_UNSIGNED_INT,
+					reinterpret_cast<const void*>(static_cast<size_t>(command.firstIndex) * sizeof(unsigned int)),
+					command.instanceCount, command.baseVertex, command.baseInstance
+				);
+			}
+
+			m_DrawCalls = m_Commands.size();
+		}
+	}
+
+	ArenaStats GeometryArena::GetStats() const {
+		ArenaStats stats;
+		stats.vertexCapacity = m_Vertices.GetCapacity();
+		stats.vertexUsed = m_Vertices.GetUsed();
+		stats.indexCapacity = m_Indices.GetCapacity();
+		stats.indexUsed = m_Indices.GetUsed();
+		stats.allocations = m_Ranges.size() - m_FreeRanges.size();
+		stats.relocations = m_Relocations;
+		stats.drawCalls = m_DrawCalls;
+		stats.draws = m_Commands.size();
+		stats.staging = m_Staging.GetStats();
+		return stats;
+	}
+
+	float GeometryArena::GetFragmentation() const {
+		/* Share of free space outside the largest free block */
+		auto fragmentation = [](const RangeAllocator& allocator) {
+			if (allocator.GetFree() == 0) {
+				return 0.0f;
+			}
+
+			return 1.0f - static_cast<float>(allocator.GetLargestFreeBlock()) / allocator.GetFree();
+		};
+
+		return std::max(fragmentation(m_Vertices), fragmentation(m_Indices));
+	}
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include "buffers.h"
+#include "arrays.h"
+#include "allocator.h"
+#include "staging.h"
+#include "extensions.h"
+
+namespace render {
+	class GeometryArena;
+
+	/* Vertex and index ranges owned by a GeometryArena, released when destroyed */
+	class ArenaAllocation {
+	private:
+		GeometryArena* m_Arena;
+		uint32_t m_ID;
+
+	public:
+		ArenaAllocation() : m_Arena(nullptr), m_ID(0) {}
+		ArenaAllocation(GeometryArena* arena, uint32_t id) : m_Arena(arena), m_ID(id) {}
+		~ArenaAllocation();
+
+		/* Disable copying */
+		ArenaAllocation(const ArenaAllocation&) = delete;
+		ArenaAllocation& operator=(const ArenaAllocation&) = delete;
+
+		/* Enable moving */
+		ArenaAllocation(ArenaAllocation&& other) noexcept;
+		ArenaAllocation& operator=(ArenaAllocation&& other) noexcept;
+
+		/* Release the ranges early */
+		void Reset();
+
+		inline bool IsValid() const { return m_Arena != nullptr; }
+		inline uint32_t GetID() const { return m_ID; }
+	};
+
+	struct ArenaStats {
+		size_t vertexCapacity = 0;
+		size_t vertexUsed = 0;
+		size_t indexCapacity = 0;
+		size_t indexUsed = 0;
+		size_t allocations = 0;
+		size_t relocations = 0; // Times the buffers were compacted or grown
+		size_t drawCalls = 0;   // Issued by the last Draw
+		size_t draws = 0;       // Meshes drawn by the last Draw
+		StagingStats staging;   // Mesh uploads, since creation
+	};
+
+	/* Staging space arenas upload through unless told otherwise */
+	constexpr size_t DEFAULT_STAGING_SIZE = 4 << 20;
+
+	/*
+	 * Meshes sharing one vertex layout, suballocated from a single vertex and
+	 * index buffer behind one vertex array. Indices are stored relative to
+	 * their mesh and drawn with a base vertex, so compaction only has to move
+	 * bytes. Draws are queued with per-draw instance data and submitted with
+	 * one glMultiDrawElementsIndirect, or a loop of base instance draws where
+	 * that is unavailable. Each draw's instance data is fetched through its
+	 * base instance, so instanced attributes carry per-mesh values. Meshes
+	 * are copied in through a StagingRing, and each Draw fences the uploads
+	 * made since the last one.
+	 *
+	 * Allocations keep a pointer to the arena, so it can't be moved.
+	 */
+	class GeometryArena {
+	private:
+		struct Range {
+			size_t vertexOffset;
+			size_t vertexCount;
+			size_t indexOffset;
+			size_t indexCount;
+			bool live;
+		};
+
+		VertexBufferLayout m_VertexLayout;
+		VertexBufferLayout m_InstanceLayout;
+
+		VertexArray m_VAO;
+		VertexBuffer m_VBO;
+		ElementBuffer m_EBO;
+		RangeAllocator m_Vertices;
+		RangeAllocator m_Indices;
+		StagingRing m_Staging;
+
+		std::vector<Range> m_Ranges;
+		std::vector<uint32_t> m_FreeRanges;
+		size_t m_Relocations;
+
+		/* Queued draws */
+		std::vector<DrawElementsIndirectCommand> m_Commands;
+		std::vector<unsigned char> m_InstanceData;
+		VertexBuffer m_InstanceVBO;
+		IndirectBuffer m_IndirectBuffer;
+		size_t m_InstanceCapacity;
+		size_t m_CommandCapacity;
+		size_t m_DrawCalls;
+
+		/* Move every live range into new buffers, packed from the start */
+		void Relocate(size_t vertexCapacity, size_t indexCapacity);
+		void AttachBuffers();
+		void AttachInstances();
+
+		friend class ArenaAllocation;
+		void Release(uint32_t id);
+
+	public:
+		GeometryArena(const VertexBufferLayout& vertexLayout, const VertexBufferLayout& instanceLayout, size_t vertexCapacity, size_t indexCapacity, size_t stagingSize = DEFAULT_STAGING_SIZE);
+
+		/* Disable copying and moving */
+		GeometryArena(const GeometryArena&) = delete;
+		GeometryArena& operator=(const GeometryArena&) = delete;
+
+		/* Copy a mesh in, compacting or growing the buffers when it doesn't fit */
+		template <typename T>
+		ArenaAllocation Allocate(const std::vector<T>& vertices, const std::vector<unsigned int>& indices) {
+			return Allocate(vertices.data(), vertices.size(), indices.data(), indices.size());
+		}
+
+		ArenaAllocation Allocate(const void* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount);
+
+		/* Pack live meshes together, closing the holes left by released ones */
+		void Defragment();
+
+		/* Draw queue, instance data must match the instance layout's stride */
+		void ClearDraws();
+
+		template <typename T>
+		void AddDraw(const ArenaAllocation& allocation, const T& instance) {
+			AddDraw(allocation, &instance, sizeof(T));
+		}
+
+		void AddDraw(const ArenaAllocation& allocation, const void* instance, size_t size);
+		void Draw();
+
+		/* Getters */
+		ArenaStats GetStats() const;
+		float GetFragmentation() const;
+	};
+};
@@ -1,16 +1,17 @@
 #include "arrays.h"
+#include "state.h"
 
 #include <iostream>
 
 namespace render {
 	VertexArray::VertexArray() {
 		glGenVertexArrays(1, &m_RendererID);
-		glBindVertexArray(m_RendererID);
+		StateCache::Get().BindVertexArray(m_RendererID);
 	}
 
 	VertexArray::~VertexArray() {
 		if (m_RendererID) {
-			glDeleteVertexArrays(1, &m_RendererID);
+			StateCache::Get().DeleteVertexArray(m_RendererID);
 		}
 	}
 
@@ -22,7 +23,7 @@ namespace render {
 	VertexArray& VertexArray::operator=(VertexArray&& other) noexcept {
 		if (this != &other) {
 			if (m_RendererID) {
-				glDeleteVertexArrays(1, &m_RendererID);
+				StateCache::Get().DeleteVertexArray(m_RendererID);
 			}
 
 			m_RendererID = other.m_RendererID;
@@ -34,31 +35,61 @@ namespace render {
 
 	void VertexArray::Bind() const {
 		if (m_RendererID) {
-			glBindVertexArray(m_RendererID);
+			StateCache::Get().BindVertexArray(m_RendererID);
 		} else {
 			std::cerr << "Attempted to bind a moved vertex array" << std::endl;
 		}
 	}
 
 	void VertexArray::Unbind() const {
-		glBindVertexArray(0);
+		StateCache::Get().BindVertexArray(0);
 	}
 
 	template <>
 	void VertexBufferLayout::Push<float>(unsigned int count) {
-		m_Attributes.push_back({ GL_FLOAT, count, GL_FALSE });
+		m_Attributes.push_back({ GL_FLOAT, count, GL_FALSE, false });
 		m_Stride += count * sizeof(float);
 	}
 
+	template <>
+	void VertexBufferLayout::Push<int>(unsigned int count) {
+		m_Attributes.push_back({ GL_INT, count, GL_FALSE, false });
+		m_Stride += count * sizeof(int);
+	}
+
 	template <>
 	void VertexBufferLayout::Push<unsigned int>(unsigned int count) {
-		m_Attributes.push_back({ GL_UNSIGNED_INT, count, GL_FALSE });
+		m_Attributes.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, false });
 		m_Stride += count * sizeof(unsigned int);
 	}
 
 	template <>
 	void VertexBufferLayout::Push<unsigned char>(unsigned int count) {
-		m_Attributes.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
+		m_Attributes.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE, false });
+		m_Stride += count * sizeof(unsigned char);
+	}
+
+	template <>
+	void VertexBufferLayout::PushInteger<int>(unsigned int count) {
+		m_Attributes.push_back({ GL_INT, count, GL_FALSE, true });
+		m_Stride += count * sizeof(int);
+	}
+
+	template <>
+	void VertexBufferLayout::PushInteger<unsigned int>(unsigned int count) {
+		m_Attributes.push_back({ GL_UNSIGNED_INT, count, GL_FALSE, true });
+		m_Stride += count * sizeof(unsigned int);
+	}
+
+	template <>
+	void VertexBufferLayout::PushInteger<unsigned short>(unsigned int count) {
+		m_Attributes.push_back({ GL_UNSIGNED_SHORT, count, GL_FALSE, true });
+		m_Stride += count * sizeof(unsigned short);
+	}
+
+	template <>
+	void VertexBufferLayout::PushInteger<unsigned char>(unsigned int count) {
+		m_Attributes.push_back({ GL_UNSIGNED_BYTE, count, GL_FALSE, true });
 		m_Stride += count * sizeof(unsigned char);
 	}
 };
\ No newline at end of file
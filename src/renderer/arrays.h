@@ -11,11 +11,14 @@ namespace render {
 		unsigned int type;
 		unsigned int count;
 		unsigned char normalized;
+		bool integer; // Read as integers in the shader instead of being converted to floats
 
 		static unsigned int GetSizeOfType(unsigned int type) {
 			switch (type) {
 			case GL_FLOAT: return sizeof(float);
+			case GL_INT: return sizeof(int);
 			case GL_UNSIGNED_INT: return sizeof(unsigned int);
+			case GL_UNSIGNED_SHORT: return sizeof(unsigned short);
 			case GL_UNSIGNED_BYTE: return sizeof(unsigned char);
 			}
 
@@ -37,6 +40,11 @@ namespace render {
 			throw std::runtime_error("unsupported vertex attribute type pushed");
 		}
 
+		template <typename T>
+		void PushInteger(unsigned int count) {
+			throw std::runtime_error("unsupported integer vertex attribute type pushed");
+		}
+
 		inline const std::vector<VertexAttribute>& GetElements() const { return m_Attributes; }
 		inline unsigned int GetStride() const { return m_Stride; }
 	};
@@ -53,6 +61,18 @@ namespace render {
 	template<>
 	void VertexBufferLayout::Push<unsigned char>(unsigned int count);
 
+	template<>
+	void VertexBufferLayout::PushInteger<int>(unsigned int count);
+
+	template<>
+	void VertexBufferLayout::PushInteger<unsigned int>(unsigned int count);
+
+	template<>
+	void VertexBufferLayout::PushInteger<unsigned short>(unsigned int count);
+
+	template<>
+	void VertexBufferLayout::PushInteger<unsigned char>(unsigned int count);
+
 	class VertexArray {
 	private:
 		unsigned int m_RendererID;
@@ -72,8 +92,8 @@ namespace render {
 		void Bind() const;
 		void Unbind() const;
 
-		/* Add buffer */
-		void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout) const {
+		/* Add buffer, attributes start at firstAttribute and advance once per divisor instances if non-zero */
+		void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstAttribute = 0, unsigned int divisor = 0) const {
 			/* Bind vao and vbo */
 			Bind();
 			vb.Bind();
@@ -84,8 +104,17 @@ namespace render {
 
 			for (unsigned int i = 0; i < elements.size(); i++) {
 				const auto& element = elements[i];
-				glEnableVertexAttribArray(i);
-				glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset);
+				const unsigned int index = firstAttribute + i;
+				glEnableVertexAttribArray(index);
+
+				if (element.integer) {
+					glVertexAttribIPointer(index, element.count, element.type, layout.GetStride(), (const void*)offset);
+				} else {
+					glVertexAttribPointer(index, element.count, element.type, element.normalized, layout.GetStride(), (const void*)offset);
+				}
+
+				glVertexAttribDivisor(index, divisor);
+
 				offset += element.count * VertexAttribute::GetSizeOfType(element.type);
 			}
 		}
@@ -1,23 +1,24 @@
 #include "buffers.h"
+#include "state.h"
 
 #include <iostream>
 
 namespace render {
     VertexBuffer::VertexBuffer(const void* data, size_t size, BufferHint hint) {
         glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        StateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ARRAY_BUFFER, size, data, static_cast<GLenum>(hint));
     }
 
     VertexBuffer::VertexBuffer(BufferHint hint) {
         glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        StateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ARRAY_BUFFER, 0, nullptr, static_cast<GLenum>(hint));
     }
 
     VertexBuffer::~VertexBuffer() {
         if (m_RendererID) {
-            glDeleteBuffers(1, &m_RendererID);
+            StateCache::Get().DeleteBuffer(m_RendererID);
         }
     }
 
@@ -29,7 +30,7 @@ namespace render {
     VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept {
         if (this != &other) {
             if (m_RendererID) {
-                glDeleteBuffers(1, &m_RendererID);
+                StateCache::Get().DeleteBuffer(m_RendererID);
             }
 
             m_RendererID = other.m_RendererID;
@@ -44,9 +45,14 @@ namespace render {
         glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
     }
 
+    void VertexBuffer::SetSubData(const void* data, size_t size, size_t offset) const {
+        Bind();
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+
     void VertexBuffer::Bind() const {
         if (m_RendererID) {
-            glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+            StateCache::Get().BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         }
         else {
             std::cerr << "Attempted to bind a moved vertex buffer" << std::endl;
@@ -54,26 +60,26 @@ namespace render {
     }
 
     void VertexBuffer::Unbind() const {
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        StateCache::Get().BindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
     ElementBuffer::ElementBuffer(const std::vector<unsigned int>& data, BufferHint hint) : ElementBuffer(data.data(), data.size(), hint) {}
 
     ElementBuffer::ElementBuffer(const unsigned int* data, size_t count, BufferHint hint) : m_Count(count) {
         glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+        StateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, static_cast<GLenum>(hint));
     }
 
     ElementBuffer::ElementBuffer(BufferHint hint) : m_Count(0) {        
         glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+        StateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, 0, nullptr, static_cast<GLenum>(hint));
     }
 
     ElementBuffer::~ElementBuffer() {
         if (m_RendererID) {
-            glDeleteBuffers(1, &m_RendererID);
+            StateCache::Get().DeleteBuffer(m_RendererID);
         }
     }
 
@@ -87,7 +93,7 @@ namespace render {
     ElementBuffer& ElementBuffer::operator=(ElementBuffer&& other) noexcept {
         if (this != &other) {
             if (m_RendererID) {
-                glDeleteBuffers(1, &m_RendererID);
+                StateCache::Get().DeleteBuffer(m_RendererID);
             }
 
             m_RendererID = other.m_RendererID;
@@ -109,22 +115,195 @@ namespace render {
         m_Count = count;
     }
 
+    void ElementBuffer::SetSubData(const unsigned int* data, size_t count, size_t offset) const {
+        Bind();
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(unsigned int), count * sizeof(unsigned int), data);
+    }
+
     void ElementBuffer::Bind() const {
         if (m_RendererID) {
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+            StateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
         } else {
             std::cerr << "Attempted to bind a moved index buffer" << std::endl;
         }
     }
 
     void ElementBuffer::Unbind() const {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        StateCache::Get().BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
     }
 
     size_t ElementBuffer::GetCount() const {
         return m_Count;
     }
 
+    IndirectBuffer::IndirectBuffer(const void* data, size_t size, BufferHint hint) {
+        glGenBuffers(1, &m_RendererID);
+        StateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, size, data, static_cast<GLenum>(hint));
+    }
+
+    IndirectBuffer::~IndirectBuffer() {
+        if (m_RendererID) {
+            StateCache::Get().DeleteBuffer(m_RendererID);
+        }
+    }
+
+    IndirectBuffer::IndirectBuffer(IndirectBuffer&& other) noexcept {
+        m_RendererID = other.m_RendererID;
+        other.m_RendererID = 0;
+    }
+
+    IndirectBuffer& IndirectBuffer::operator=(IndirectBuffer&& other) noexcept {
+        if (this != &other) {
+            if (m_RendererID) {
+                StateCache::Get().DeleteBuffer(m_RendererID);
+            }
+
+            m_RendererID = other.m_RendererID;
+            other.m_RendererID = 0;
+        }
+
+        return *this;
+    }
+
+    void IndirectBuffer::SetData(const void* data, size_t size) const {
+        Bind();
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, data);
+    }
+
+    void IndirectBuffer::Bind() const {
+        if (m_RendererID) {
+            StateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID);
+        } else {
+            std::cerr << "Attempted to bind a moved indirect buffer" << std::endl;
+        }
+    }
+
+    void IndirectBuffer::Unbind() const {
+        StateCache::Get().BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    UniformBuffer::UniformBuffer(size_t size, BufferHint hint) : m_Size(size) {
+        glGenBuffers(1, &m_RendererID);
+        StateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+        glBufferData(GL_UNIFORM_BUFFER, size, nullptr, static_cast<GLenum>(hint));
+    }
+
+    UniformBuffer::~UniformBuffer() {
+        if (m_RendererID) {
+            StateCache::Get().DeleteBuffer(m_RendererID);
+        }
+    }
+
+    UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept {
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+    }
+
+    UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept {
+        if (this != &other) {
+            if (m_RendererID) {
+                StateCache::Get().DeleteBuffer(m_RendererID);
+            }
+
+            m_RendererID = other.m_RendererID;
+            m_Size = other.m_Size;
+            other.m_RendererID = 0;
+            other.m_Size = 0;
+        }
+
+        return *this;
+    }
+
+    void UniformBuffer::SetData(const void* data, size_t size, size_t offset) const {
+        if (offset + size > m_Size) {
+            std::cerr << "Attempted to write past the end of a uniform buffer" << std::endl;
+            return;
+        }
+
+        Bind();
+        glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    }
+
+    void UniformBuffer::BindBase(unsigned int index) const {
+        StateCache::Get().BindBufferBase(GL_UNIFORM_BUFFER, index, m_RendererID);
+    }
+
+    void UniformBuffer::Bind() const {
+        if (m_RendererID) {
+            StateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+        } else {
+            std::cerr << "Attempted to bind a moved uniform buffer" << std::endl;
+        }
+    }
+
+    void UniformBuffer::Unbind() const {
+        StateCache::Get().BindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    PixelBuffer::PixelBuffer(size_t size, BufferHint hint) : m_Size(size) {
+        glGenBuffers(1, &m_RendererID);
+        StateCache::Get().BindBuffer(GL_PIXEL_PACK_BUFFER, m_RendererID);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, static_cast<GLenum>(hint));
+    }
+
+    PixelBuffer::~PixelBuffer() {
+        if (m_RendererID) {
+            StateCache::Get().DeleteBuffer(m_RendererID);
+        }
+    }
+
+    PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept {
+        m_RendererID = other.m_RendererID;
+        m_Size = other.m_Size;
+        other.m_RendererID = 0;
+        other.m_Size = 0;
+    }
+
+    PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept {
+        if (this != &other) {
+            if (m_RendererID) {
+                StateCache::Get().DeleteBuffer(m_RendererID);
+            }
+
+            m_RendererID = other.m_RendererID;
+            m_Size = other.m_Size;
+            other.m_RendererID = 0;
+            other.m_Size = 0;
+        }
+
+        return *this;
+    }
+
+    const void* PixelBuffer::Map(size_t size, size_t offset) const {
+        if (offset + size > m_Size) {
+            std::cerr << "Attempted to map past the end of a pixel buffer" << std::endl;
+            return nullptr;
+        }
+
+        Bind();
+        return glMapBufferRange(GL_PIXEL_PACK_BUFFER, offset, size, GL_MAP_READ_BIT);
+    }
+
+    void PixelBuffer::Unmap() const {
+        Bind();
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    void PixelBuffer::Bind() const {
+        if (m_RendererID) {
+            StateCache::Get().BindBuffer(GL_PIXEL_PACK_BUFFER, m_RendererID);
+        } else {
+            std::cerr << "Attempted to bind a moved pixel buffer" << std::endl;
+        }
+    }
+
+    void PixelBuffer::Unbind() const {
+        StateCache::Get().BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
     FrameBuffer::FrameBuffer() {
         glGenFramebuffers(1, &m_RendererID);
         glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
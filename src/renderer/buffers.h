@@ -9,7 +9,8 @@ namespace render {
     enum class BufferHint {
         STATIC_DRAW = GL_STATIC_DRAW,
         DYNAMIC_DRAW = GL_DYNAMIC_DRAW,
-        STREAM_DRAW = GL_STREAM_DRAW
+        STREAM_DRAW = GL_STREAM_DRAW,
+        STREAM_READ = GL_STREAM_READ
     };
 
     class VertexBuffer {
@@ -38,10 +39,14 @@ namespace render {
         }
 
         void SetData(const void* data, size_t size) const;
+        void SetSubData(const void* data, size_t size, size_t offset) const;
 
         /* Bind and unbind */
         void Bind() const;
         void Unbind() const;
+
+        /* Get renderer ID */
+        inline unsigned int GetRendererID() const { return m_RendererID; }
     };
 
     class ElementBuffer {
@@ -65,6 +70,7 @@ namespace render {
         /* Set data */
         void SetData(const std::vector<unsigned int>& data);
         void SetData(const unsigned int* data, size_t count);
+        void SetSubData(const unsigned int* data, size_t count, size_t offset) const;
 
         /* Bind and unbind */
         void Bind() const;
@@ -72,6 +78,96 @@ namespace render {
 
         /* Get count */
         size_t GetCount() const;
+
+        /* Get renderer ID */
+        inline unsigned int GetRendererID() const { return m_RendererID; }
+    };
+
+    class IndirectBuffer {
+    private:
+        unsigned int m_RendererID;
+    public:
+        IndirectBuffer(const void* data, size_t size, BufferHint hint = BufferHint::STREAM_DRAW);
+        ~IndirectBuffer();
+
+        /* Disable copying */
+        IndirectBuffer(const IndirectBuffer&) = delete;
+        IndirectBuffer& operator=(const IndirectBuffer&) = delete;
+
+        /* Enable moving */
+        IndirectBuffer(IndirectBuffer&& other) noexcept;
+        IndirectBuffer& operator=(IndirectBuffer&& other) noexcept;
+
+        /* Set data */
+        void SetData(const void* data, size_t size) const;
+
+        /* Bind and unbind */
+        void Bind() const;
+        void Unbind() const;
+    };
+
+    class UniformBuffer {
+    private:
+        unsigned int m_RendererID;
+        size_t m_Size;
+    public:
+        UniformBuffer(size_t size, BufferHint hint = BufferHint::DYNAMIC_DRAW);
+        ~UniformBuffer();
+
+        /* Disable copying */
+        UniformBuffer(const UniformBuffer&) = delete;
+        UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+        /* Enable moving */
+        UniformBuffer(UniformBuffer&& other) noexcept;
+        UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+        /* Set data */
+        template <typename T>
+        void SetData(const T& data) const {
+            SetData(&data, sizeof(T), 0);
+        }
+
+        void SetData(const void* data, size_t size, size_t offset) const;
+
+        /* Attach to a uniform block binding point */
+        void BindBase(unsigned int index) const;
+
+        /* Bind and unbind */
+        void Bind() const;
+        void Unbind() const;
+
+        /* Get size */
+        inline size_t GetSize() const { return m_Size; }
+    };
+
+    /* Pixel pack target, glReadPixels writes into it instead of client memory */
+    class PixelBuffer {
+    private:
+        unsigned int m_RendererID;
+        size_t m_Size;
+    public:
+        PixelBuffer(size_t size, BufferHint hint = BufferHint::STREAM_READ);
+        ~PixelBuffer();
+
+        /* Disable copying */
+        PixelBuffer(const PixelBuffer&) = delete;
+        PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+        /* Enable moving */
+        PixelBuffer(PixelBuffer&& other) noexcept;
+        PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+
+        /* Map for reading, stalls unless the writes into it have finished */
+        const void* Map(size_t size, size_t offset = 0) const;
+        void Unmap() const;
+
+        /* Bind and unbind */
+        void Bind() const;
+        void Unbind() const;
+
+        /* Get size */
+        inline size_t GetSize() const { return m_Size; }
     };
 
     class RenderBuffer {
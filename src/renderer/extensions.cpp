@@ -0,0 +1,63 @@
+#include "extensions.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace render {
+	static PFNMULTIDRAWELEMENTSINDIRECTPROC s_MultiDrawElementsIndirect = nullptr;
+	static PFNBUFFERSTORAGEPROC s_BufferStorage = nullptr;
+
+	static bool HasVersion(int major, int minor) {
+		return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+	}
+
+	static bool HasExtension(const char* name) {
+		int count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+		for (int i = 0; i < count; i++) {
+			const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+			if (extension != nullptr && std::strcmp(extension, name) == 0) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void LoadExtensions(GLADloadproc load) {
+		/* Multi draw indirect */
+		if (HasVersion(4, 3) || HasExtension("GL_ARB_multi_draw_indirect")) {
+			s_MultiDrawElementsIndirect = reinterpret_cast<PFNMULTIDRAWELEMENTSINDIRECTPROC>(load("glMultiDrawElementsIndirect"));
+		}
+
+		/* Buffer storage */
+		if (HasVersion(4, 4) || HasExtension("GL_ARB_buffer_storage")) {
+			s_BufferStorage = reinterpret_cast<PFNBUFFERSTORAGEPROC>(load("glBufferStorage"));
+		}
+
+		std::cout << "Multi draw indirect: " << (HasMultiDrawIndirect() ? "supported" : "unsupported") << std::endl;
+		std::cout << "Buffer storage: " << (HasBufferStorage() ? "supported" : "unsupported") << std::endl;
+	}
+
+	bool HasMultiDrawIndirect() {
+		return s_MultiDrawElementsIndirect != nullptr;
+	}
+
+	void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride) {
+		s_MultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+	}
+
+	bool HasBufferStorage() {
+		return s_BufferStorage != nullptr;
+	}
+
+	void BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) {
+		s_BufferStorage(target, size, data, flags);
+	}
+
+	void DisableExtensions() {
+		s_MultiDrawElementsIndirect = nullptr;
+		s_BufferStorage = nullptr;
+	}
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace render {
+	/*
+	 * Entry points past the GL 4.2 core profile glad was generated for. They
+	 * are loaded by hand after gladLoadGLLoader and stay null when neither the
+	 * context version nor the matching ARB extension provides them, so check
+	 * the Has* functions before calling.
+	 */
+	typedef void (APIENTRYP PFNMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+	typedef void (APIENTRYP PFNBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+	/* Buffer storage and mapping flags */
+	constexpr GLbitfield MAP_PERSISTENT_BIT = 0x0040;
+	constexpr GLbitfield MAP_COHERENT_BIT = 0x0080;
+
+	struct DrawElementsIndirectCommand {
+		unsigned int count;
+		unsigned int instanceCount;
+		unsigned int firstIndex;
+		int baseVertex;
+		unsigned int baseInstance;
+	};
+
+	/* Call once with the same loader given to glad, needs a current context */
+	void LoadExtensions(GLADloadproc load);
+
+	/* GL 4.3 or ARB_multi_draw_indirect */
+	bool HasMultiDrawIndirect();
+	void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+	/* GL 4.4 or ARB_buffer_storage */
+	bool HasBufferStorage();
+	void BufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+	/* Ignore extensions even when present, for testing fallback paths */
+	void DisableExtensions();
+};
@@ -47,12 +47,7 @@ namespace render {
 	}
 
 	void Mesh::Draw(ShaderProgram& program) const {
-		const static int textures[] = {
-			0, 1, 2, 3, 4, 5, 6, 7, 8, 
-			9, 10, 11, 12, 13, 15, 16
-		};
-
-		/* Bind textures */
+		/* Bind textures, samplers pick their unit with layout(binding) */
 		for (size_t i = 0; i < m_Textures.size(); i++) {
 			m_Textures[i]->Bind(static_cast<unsigned int>(i));
 		}
@@ -62,7 +57,6 @@ namespace render {
 
 		/* Bind program */
 		program.Bind();
-		program.SetUniform1iv("u_Texture", m_Textures.size(), textures);
 
 		/* Draw */
 		glDrawElements(GL_TRIANGLES, m_EBO.GetCount(), GL_UNSIGNED_INT, nullptr);
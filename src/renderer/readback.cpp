@@ -0,0 +1,219 @@
+#include "readback.h"
+
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#include <stb/stb_image.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb/stb_image_write.h>
+
+namespace render {
+	/* Reads never wait longer than this at once while flushing, in nanoseconds */
+	constexpr GLuint64 FLUSH_TIMEOUT = 100000000;
+
+	ReadbackQueue::~ReadbackQueue() {
+		/* Pending reads are dropped, their callbacks never run */
+		for (Request& request : m_InFlight) {
+			glDeleteSync(request.fence);
+		}
+	}
+
+	PixelBuffer ReadbackQueue::AcquireBuffer(size_t size) {
+		for (size_t i = 0; i < m_FreeBuffers.size(); i++) {
+			if (m_FreeBuffers[i].GetSize() >= size) {
+				PixelBuffer buffer = std::move(m_FreeBuffers[i]);
+				m_FreeBuffers.erase(m_FreeBuffers.begin() + i);
+				return buffer;
+			}
+		}
+
+		return PixelBuffer(size);
+	}
+
+	void ReadbackQueue::Read(int x, int y, int width, int height, ReadbackCallback callback) {
+		if (width <= 0 || height <= 0) {
+			std::cerr << "Attempted to read back an empty region" << std::endl;
+			return;
+		}
+
+		const size_t size = static_cast<size_t>(width) * height * 4;
+		PixelBuffer buffer = AcquireBuffer(size);
+
+		/* With a pack buffer bound the pointer is an offset, so this only queues the copy */
+		buffer.Bind();
+		glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		buffer.Unbind();
+
+		Request request{ std::move(buffer), glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), {}, std::move(callback) };
+		request.image.x = x;
+		request.image.y = y;
+		request.image.width = width;
+		request.image.height = height;
+		m_InFlight.push_back(std::move(request));
+	}
+
+	void ReadbackQueue::Deliver(Request& request) {
+		glDeleteSync(request.fence);
+
+		/* The copy has finished, so mapping doesn't wait */
+		const size_t size = static_cast<size_t>(request.image.width) * request.image.height * 4;
+		const void* data = request.buffer.Map(size);
+		if (data != nullptr) {
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			request.image.pixels.assign(bytes, bytes + size);
+			request.buffer.Unmap();
+		}
+
+		request.buffer.Unbind();
+		m_FreeBuffers.push_back(std::move(request.buffer));
+
+		if (data != nullptr && request.callback) {
+			request.callback(std::move(request.image));
+		}
+	}
+
+	size_t ReadbackQueue::Poll() {
+		size_t count = 0;
+		while (!m_InFlight.empty()) {
+			Request& request = m_InFlight.front();
+
+			GLenum status = glClientWaitSync(request.fence, 0, 0);
+			if (status == GL_TIMEOUT_EXPIRED) {
+				break;
+			}
+
+			/* Take it out first, the callback may queue another read */
+			Request finished = std::move(request);
+			m_InFlight.pop_front();
+
+			if (status == GL_WAIT_FAILED) {
+				std::cerr << "Failed to wait for a framebuffer read" << std::endl;
+				glDeleteSync(finished.fence);
+				continue;
+			}
+
+			Deliver(finished);
+			count++;
+		}
+
+		return count;
+	}
+
+	void ReadbackQueue::Flush() {
+		while (!m_InFlight.empty()) {
+			GLenum status = glClientWaitSync(m_InFlight.front().fence, GL_SYNC_FLUSH_COMMANDS_BIT, FLUSH_TIMEOUT);
+			if (status == GL_WAIT_FAILED) {
+				std::cerr << "Failed to wait for a framebuffer read" << std::endl;
+				glDeleteSync(m_InFlight.front().fence);
+				m_InFlight.pop_front();
+				continue;
+			}
+
+			Poll();
+		}
+	}
+
+	ImageWriter::ImageWriter() : m_Stopping(false) {
+		m_Thread = std::thread(&ImageWriter::WriterLoop, this);
+	}
+
+	ImageWriter::~ImageWriter() {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+		}
+
+		m_Condition.notify_one();
+		m_Thread.join();
+	}
+
+	void ImageWriter::Save(const std::filesystem::path& path, ReadbackImage&& image) {
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push_back({ path, std::move(image) });
+		}
+
+		m_Condition.notify_one();
+	}
+
+	void ImageWriter::WriterLoop() {
+		for (;;) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this] { return m_Stopping || !m_Jobs.empty(); });
+
+				/* Finish what was queued before stopping */
+				if (m_Jobs.empty()) {
+					return;
+				}
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+
+			/* PNG rows go top to bottom */
+			const ReadbackImage& image = job.image;
+			const size_t stride = static_cast<size_t>(image.width) * 4;
+			std::vector<unsigned char> flipped(image.pixels.size());
+			for (int row = 0; row < image.height; row++) {
+				std::memcpy(&flipped[row * stride], &image.pixels[(image.height - 1 - row) * stride], stride);
+			}
+
+			std::error_code error;
+			if (job.path.has_parent_path()) {
+				std::filesystem::create_directories(job.path.parent_path(), error);
+			}
+
+			if (!stbi_write_png(job.path.string().c_str(), image.width, image.height, 4, flipped.data(), static_cast<int>(stride))) {
+				std::cerr << "Failed to write image: " << job.path << std::endl;
+			}
+		}
+	}
+
+	ImageDifference CompareImages(const ReadbackImage& a, const ReadbackImage& b, int tolerance) {
+		ImageDifference difference;
+		if (a.width != b.width || a.height != b.height || a.pixels.size() != b.pixels.size()) {
+			std::cerr << "Attempted to compare images of different sizes" << std::endl;
+			difference.pixels = std::max(a.pixels.size(), b.pixels.size()) / 4;
+			difference.maxDelta = 255;
+			return difference;
+		}
+
+		for (size_t i = 0; i < a.pixels.size(); i += 4) {
+			int delta = 0;
+			for (size_t channel = 0; channel < 4; channel++) {
+				delta = std::max(delta, std::abs(a.pixels[i + channel] - b.pixels[i + channel]));
+			}
+
+			if (delta > tolerance) {
+				difference.pixels++;
+			}
+
+			difference.maxDelta = std::max(difference.maxDelta, delta);
+		}
+
+		return difference;
+	}
+
+	bool LoadImage(const std::filesystem::path& path, ReadbackImage& image) {
+		int width, height, channels;
+		stbi_set_flip_vertically_on_load(true);
+		unsigned char* data = stbi_load(path.string().c_str(), &width, &height, &channels, 4);
+		if (data == nullptr) {
+			std::cerr << "Failed to load image: " << path << std::endl;
+			return false;
+		}
+
+		image.x = 0;
+		image.y = 0;
+		image.width = width;
+		image.height = height;
+		image.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+		stbi_image_free(data);
+		return true;
+	}
+};
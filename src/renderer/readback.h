@@ -0,0 +1,112 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include <condition_variable>
+
+#include <glad/glad.h>
+
+#include "buffers.h"
+
+namespace render {
+	/* RGBA8 pixels of a framebuffer region, bottom row first like GL */
+	struct ReadbackImage {
+		int x = 0;
+		int y = 0;
+		int width = 0;
+		int height = 0;
+		std::vector<unsigned char> pixels;
+	};
+
+	using ReadbackCallback = std::function<void(ReadbackImage&&)>;
+
+	/*
+	 * Framebuffer reads that don't stall. Read copies the region into a pixel
+	 * buffer and drops a fence behind it; Poll hands every read whose fence
+	 * has signalled to its callback, usually a frame or two later. Fences
+	 * signal in submission order, so polling stops at the first one still
+	 * pending. Pixel buffers are recycled once their read is delivered.
+	 *
+	 * Render thread only, callbacks run inside Poll.
+	 */
+	class ReadbackQueue {
+	private:
+		struct Request {
+			PixelBuffer buffer;
+			GLsync fence;
+			ReadbackImage image;
+			ReadbackCallback callback;
+		};
+
+		std::deque<Request> m_InFlight;
+		std::vector<PixelBuffer> m_FreeBuffers;
+
+		PixelBuffer AcquireBuffer(size_t size);
+		void Deliver(Request& request);
+
+	public:
+		ReadbackQueue() = default;
+		~ReadbackQueue();
+
+		/* Disable copying */
+		ReadbackQueue(const ReadbackQueue&) = delete;
+		ReadbackQueue& operator=(const ReadbackQueue&) = delete;
+
+		/* Queue a read of the bound read framebuffer */
+		void Read(int x, int y, int width, int height, ReadbackCallback callback);
+
+		/* Deliver finished reads without waiting, returns how many there were */
+		size_t Poll();
+
+		/* Wait for and deliver every read, for shutdown and tests */
+		void Flush();
+
+		inline size_t GetInFlightCount() const { return m_InFlight.size(); }
+	};
+
+	/*
+	 * Background PNG encoder. Save returns immediately, the image is flipped
+	 * and written on the writer thread. Queued images are still written when
+	 * the writer is destroyed.
+	 */
+	class ImageWriter {
+	private:
+		struct Job {
+			std::filesystem::path path;
+			ReadbackImage image;
+		};
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		std::deque<Job> m_Jobs;
+		bool m_Stopping;
+		std::thread m_Thread;
+
+		void WriterLoop();
+
+	public:
+		ImageWriter();
+		~ImageWriter();
+
+		/* Disable copying */
+		ImageWriter(const ImageWriter&) = delete;
+		ImageWriter& operator=(const ImageWriter&) = delete;
+
+		void Save(const std::filesystem::path& path, ReadbackImage&& image);
+	};
+
+	struct ImageDifference {
+		size_t pixels = 0;   // Pixels with a channel off by more than the tolerance
+		int maxDelta = 0;    // Largest difference of any channel
+	};
+
+	/* Compare two images channel by channel, sizes must match */
+	ImageDifference CompareImages(const ReadbackImage& a, const ReadbackImage& b, int tolerance = 0);
+
+	/* Load a reference image as RGBA8, bottom row first */
+	bool LoadImage(const std::filesystem::path& path, ReadbackImage& image);
+};
@@ -1,4 +1,5 @@
 #include "shaders.h"
+#include "state.h"
 
 #include <iostream>
 #include <fstream>
@@ -126,33 +127,59 @@ namespace render {
 
 			/* Clean up */
 			delete[] message;
-			glDeleteProgram(m_RendererID);
+			StateCache::Get().DeleteProgram(m_RendererID);
 			
 			/* Reset */
 			m_RendererID = 0;
+			return;
 		}
 
-		/* Use shader */
-		Bind();
+		/* Resolve every active uniform up front, arrays under both "name" and "name[0]" */
+		int count = 0;
+		glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count);
+
+		for (int i = 0; i < count; i++) {
+			char name[256];
+			int length, size;
+			unsigned int type;
+			glGetActiveUniform(m_RendererID, i, sizeof(name), &length, &size, &type, name);
+
+			/* Uniforms inside blocks have no location */
+			int location = glGetUniformLocation(m_RendererID, name);
+			if (location == -1) {
+				continue;
+			}
+
+			std::string uniform(name, length);
+			m_UniformCache[uniform] = location;
+
+			if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0) {
+				m_UniformCache[uniform.substr(0, uniform.size() - 3)] = location;
+			}
+		}
 	}
 
 	ShaderProgram::~ShaderProgram() {
 		if (m_RendererID) {
-			glDeleteProgram(m_RendererID);
+			StateCache::Get().DeleteProgram(m_RendererID);
 		}
 	}
 
 	ShaderProgram::ShaderProgram(ShaderProgram&& other) noexcept {
 		m_RendererID = other.m_RendererID;
+		m_UniformCache = std::move(other.m_UniformCache);
+		other.m_RendererID = 0;
 	}
 
 	ShaderProgram& ShaderProgram::operator=(ShaderProgram&& other) noexcept {
 		if (this != &other) {
 			if (m_RendererID) {
-				glDeleteProgram(m_RendererID);
+				StateCache::Get().DeleteProgram(m_RendererID);
 			}
 
 			m_RendererID = other.m_RendererID;
+			m_UniformCache = std::move(other.m_UniformCache);
+			other.m_RendererID = 0;
 		}
 
 		return *this;
@@ -160,19 +187,20 @@ namespace render {
 
 	void ShaderProgram::Bind() const {
 		if (m_RendererID) {
-			glUseProgram(m_RendererID);
+			StateCache::Get().UseProgram(m_RendererID);
 		} else {
 			std::cerr << "Attempted to bind a moved shader program" << std::endl;
 		}
 	}
 
 	void ShaderProgram::Unbind() const {
-		glUseProgram(0);
+		StateCache::Get().UseProgram(0);
 	}
 
 	int ShaderProgram::GetUniformLocation(const std::string& name) {
-		if (m_UniformCache.find(name) != m_UniformCache.end()) {
-			return m_UniformCache[name];
+		auto cached = m_UniformCache.find(name);
+		if (cached != m_UniformCache.end()) {
+			return cached->second;
 		}
 
 		int location = glGetUniformLocation(m_RendererID, name.c_str());
@@ -185,24 +213,82 @@ namespace render {
 	}
 
 	void ShaderProgram::SetUniform1iv(const std::string& name, int count, const int* value) {
-		Bind();
-
-		int location = GetUniformLocation(name);
-		glUniform1iv(location, count, value);
+		GetUniform<int>(name).Set(value, count);
 	}
 
-
 	void ShaderProgram::SetUniform2f(const std::string& name, float v0, float v1) {
-		Bind();
+		GetUniform<glm::vec2>(name).Set(glm::vec2(v0, v1));
+	}
 
-		int location = GetUniformLocation(name);
-		glUniform2f(location, v0, v1);
+	void ShaderProgram::SetUniform3f(const std::string& name, float v0, float v1, float v2) {
+		GetUniform<glm::vec3>(name).Set(glm::vec3(v0, v1, v2));
+	}
+
+	void ShaderProgram::SetUniform3fv(const std::string& name, int count, const glm::vec3* value) {
+		GetUniform<glm::vec3>(name).Set(value, count);
 	}
 
 	void ShaderProgram::SetUniformMat4f(const std::string& name, glm::mat4 matrix) {
-		Bind();
+		GetUniform<glm::mat4>(name).Set(matrix);
+	}
+
+	template<>
+	void Uniform<int>::Set(const int& value) const {
+		glProgramUniform1i(m_Program, m_Location, value);
+	}
+
+	template<>
+	void Uniform<int>::Set(const int* values, int count) const {
+		glProgramUniform1iv(m_Program, m_Location, count, values);
+	}
+
+	template<>
+	void Uniform<float>::Set(const float& value) const {
+		glProgramUniform1f(m_Program, m_Location, value);
+	}
+
+	template<>
+	void Uniform<float>::Set(const float* values, int count) const {
+		glProgramUniform1fv(m_Program, m_Location, count, values);
+	}
+
+	template<>
+	void Uniform<glm::vec2>::Set(const glm::vec2& value) const {
+		glProgramUniform2f(m_Program, m_Location, value.x, value.y);
+	}
+
+	template<>
+	void Uniform<glm::vec2>::Set(const glm::vec2* values, int count) const {
+		glProgramUniform2fv(m_Program, m_Location, count, &values[0].x);
+	}
+
+	template<>
+	void Uniform<glm::vec3>::Set(const glm::vec3& value) const {
+		glProgramUniform3f(m_Program, m_Location, value.x, value.y, value.z);
+	}
+
+	template<>
+	void Uniform<glm::vec3>::Set(const glm::vec3* values, int count) const {
+		glProgramUniform3fv(m_Program, m_Location, count, &values[0].x);
+	}
+
+	template<>
+	void Uniform<glm::vec4>::Set(const glm::vec4& value) const {
+		glProgramUniform4f(m_Program, m_Location, value.x, value.y, value.z, value.w);
+	}
+
+	template<>
+	void Uniform<glm::vec4>::Set(const glm::vec4* values, int count) const {
+		glProgramUniform4fv(m_Program, m_Location, count, &values[0].x);
+	}
+
+	template<>
+	void Uniform<glm::mat4>::Set(const glm::mat4& value) const {
+		glProgramUniformMatrix4fv(m_Program, m_Location, 1, GL_FALSE, &value[0][0]);
+	}
 
-		int location = GetUniformLocation(name);
-		glUniformMatrix4fv(location, 1, GL_FALSE, &matrix[0][0]);
+	template<>
+	void Uniform<glm::mat4>::Set(const glm::mat4* values, int count) const {
+		glProgramUniformMatrix4fv(m_Program, m_Location, count, GL_FALSE, &values[0][0][0]);
 	}
 };
\ No newline at end of file
@@ -36,6 +36,39 @@ namespace render {
 		inline const std::vector<unsigned int>& GetShaders() const { return m_Shaders; }
 	};
 
+	/*
+	 * Uniform location looked up once, set with glProgramUniform so the
+	 * program doesn't need to be bound. Setting an invalid handle is a no-op.
+	 */
+	template <typename T>
+	class Uniform {
+	private:
+		unsigned int m_Program;
+		int m_Location;
+
+	public:
+		Uniform() : m_Program(0), m_Location(-1) {}
+		Uniform(unsigned int program, int location) : m_Program(program), m_Location(location) {}
+
+		void Set(const T& value) const;
+		void Set(const T* values, int count) const;
+
+		inline bool IsValid() const { return m_Location != -1; }
+	};
+
+	template<> void Uniform<int>::Set(const int& value) const;
+	template<> void Uniform<int>::Set(const int* values, int count) const;
+	template<> void Uniform<float>::Set(const float& value) const;
+	template<> void Uniform<float>::Set(const float* values, int count) const;
+	template<> void Uniform<glm::vec2>::Set(const glm::vec2& value) const;
+	template<> void Uniform<glm::vec2>::Set(const glm::vec2* values, int count) const;
+	template<> void Uniform<glm::vec3>::Set(const glm::vec3& value) const;
+	template<> void Uniform<glm::vec3>::Set(const glm::vec3* values, int count) const;
+	template<> void Uniform<glm::vec4>::Set(const glm::vec4& value) const;
+	template<> void Uniform<glm::vec4>::Set(const glm::vec4* values, int count) const;
+	template<> void Uniform<glm::mat4>::Set(const glm::mat4& value) const;
+	template<> void Uniform<glm::mat4>::Set(const glm::mat4* values, int count) const;
+
 	class ShaderProgram {
 	private:
 		unsigned int m_RendererID;
@@ -56,12 +89,20 @@ namespace render {
 		void Bind() const;
 		void Unbind() const;
 
-		/* Uniform location */
+		/* Uniform location, active uniforms are cached when the program links */
 		int GetUniformLocation(const std::string& name);
 
+		/* Typed handle, resolve once and keep it around */
+		template <typename T>
+		Uniform<T> GetUniform(const std::string& name) {
+			return Uniform<T>(m_RendererID, GetUniformLocation(name));
+		}
+
 		/* Set uniform */
 		void SetUniform1iv(const std::string& name, int count, const int* value);
 		void SetUniform2f(const std::string& name, float v0, float v1);
+		void SetUniform3f(const std::string& name, float v0, float v1, float v2);
+		void SetUniform3fv(const std::string& name, int count, const glm::vec3* value);
 		void SetUniformMat4f(const std::string& name, glm::mat4 matrix);
 	};
 };
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "staging.h"
+#include "state.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace render {
+	/* Every upload starts on this boundary, so memcpy works on aligned memory */
+	constexpr size_t STAGING_ALIGNMENT = 16;
+
+	/* Waiting for a full ring never blocks longer than this at once, in nanoseconds */
+	constexpr GLuint64 STAGING_TIMEOUT = 100000000;
+
+	StagingRing::StagingRing(size_t size) :
+		m_RendererID(0),
+		m_Mapped(nullptr),
+		m_Size(size / STAGING_ALIGNMENT * STAGING_ALIGNMENT),
+		m_Head(0),
+		m_Tail(0),
+		m_Fenced(0)
+	{
+		if (!HasBufferStorage() || m_Size == 0) {
+			return;
+		}
+
+		glGenBuffers(1, &m_RendererID);
+		StateCache::Get().BindBuffer(GL_COPY_READ_BUFFER, m_RendererID);
+
+		/* Coherent, so writes are visible to copies issued after them without flushing */
+		const GLbitfield flags = GL_MAP_WRITE_BIT | MAP_PERSISTENT_BIT | MAP_COHERENT_BIT;
+		BufferStorage(GL_COPY_READ_BUFFER, m_Size, nullptr, flags);
+		m_Mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, m_Size, flags));
+
+		if (m_Mapped == nullptr) {
+			std::cerr << "Failed to map the staging buffer, uploading directly" << std::endl;
+			StateCache::Get().DeleteBuffer(m_RendererID);
+			m_RendererID = 0;
+		}
+	}
+
+	StagingRing::~StagingRing() {
+		for (Segment& segment : m_Segments) {
+			glDeleteSync(segment.fence);
+		}
+
+		if (m_RendererID) {
+			StateCache::Get().BindBuffer(GL_COPY_READ_BUFFER, m_RendererID);
+			glUnmapBuffer(GL_COPY_READ_BUFFER);
+			StateCache::Get().DeleteBuffer(m_RendererID);
+		}
+	}
+
+	void StagingRing::Retire(bool wait) {
+		while (!m_Segments.empty()) {
+			Segment& segment = m_Segments.front();
+
+			GLenum status = glClientWaitSync(segment.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? STAGING_TIMEOUT : 0);
+			if (status == GL_TIMEOUT_EXPIRED) {
+				if (!wait) {
+					break;
+				}
+
+				continue;
+			}
+
+			if (status == GL_WAIT_FAILED) {
+				std::cerr << "Failed to wait for a staging copy" << std::endl;
+			}
+
+			m_Tail = segment.end;
+			glDeleteSync(segment.fence);
+			m_Segments.pop_front();
+
+			/* One segment is enough for a caller that had to wait */
+			if (wait) {
+				break;
+			}
+		}
+	}
+
+	uint64_t StagingRing::Reserve(size_t size) {
+		/* Copies can't wrap, skip to the start when the rest of the ring is too short */
+		uint64_t position = m_Head;
+		const size_t offset = static_cast<size_t>(position % m_Size);
+		if (offset + size > m_Size) {
+			position += m_Size - offset;
+		}
+
+		Retire(false);
+		while (position + size - m_Tail > m_Size) {
+			if (m_Segments.empty()) {
+				/* Nothing in use, start over at the wrap */
+				if (m_Head == m_Fenced) {
+					m_Head = m_Tail = m_Fenced = position;
+					break;
+				}
+
+				/* Bytes written this frame hold the space, fence them to wait on */
+				Fence();
+			}
+
+			m_Stats.stalls++;
+			Retire(true);
+		}
+
+		m_Head = position + (size + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+		return position;
+	}
+
+	void StagingRing::Upload(unsigned int buffer, size_t offset, const void* data, size_t size) {
+		if (size == 0) {
+			return;
+		}
+
+		if (m_Mapped == nullptr || size > m_Size) {
+			StateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+			m_Stats.direct += size;
+			return;
+		}
+
+		const size_t source = static_cast<size_t>(Reserve(size) % m_Size);
+		std::memcpy(m_Mapped + source, data, size);
+
+		StateCache::Get().BindBuffer(GL_COPY_READ_BUFFER, m_RendererID);
+		StateCache::Get().BindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source, offset, size);
+		m_Stats.staged += size;
+	}
+
+	void StagingRing::Fence() {
+		if (m_Head == m_Fenced) {
+			return;
+		}
+
+		m_Segments.push_back({ m_Head, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+		m_Fenced = m_Head;
+	}
+};
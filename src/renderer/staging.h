@@ -0,0 +1,72 @@
+#pragma once
+
+#include <deque>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/glad.h>
+
+#include "extensions.h"
+
+namespace render {
+	struct StagingStats {
+		size_t staged = 0;   // Bytes copied through the ring
+		size_t direct = 0;   // Bytes written with glBufferSubData instead
+		size_t stalls = 0;   // Times the ring was full and had to wait for the GPU
+	};
+
+	/*
+	 * Ring buffer uploads pass through on their way into static buffers. With
+	 * GL 4.4 or ARB_buffer_storage it is mapped once, persistently, so staging
+	 * is a memcpy followed by a GPU side copy into place, and the driver never
+	 * has to take a copy of its own or wait for the destination to go idle.
+	 * Bytes written since the last Fence are fenced together and only written
+	 * over once that fence has signalled; a full ring waits for the oldest.
+	 * Without buffer storage, or for uploads larger than the ring, bytes go
+	 * straight into the destination with glBufferSubData.
+	 *
+	 * Render thread only.
+	 */
+	class StagingRing {
+	private:
+		struct Segment {
+			uint64_t end; // Ring position the segment's bytes end at
+			GLsync fence;
+		};
+
+		unsigned int m_RendererID;
+		unsigned char* m_Mapped;
+		size_t m_Size;
+
+		/* Positions only grow, the offset into the buffer is position modulo size */
+		uint64_t m_Head;   // Next byte to write
+		uint64_t m_Tail;   // Oldest byte the GPU may still read
+		uint64_t m_Fenced; // End of the last fenced segment
+		std::deque<Segment> m_Segments;
+		StagingStats m_Stats;
+
+		/* Free segments whose copies have finished, waiting for the oldest if wait is set */
+		void Retire(bool wait);
+
+		/* Find room for size contiguous bytes, returns the ring position */
+		uint64_t Reserve(size_t size);
+
+	public:
+		StagingRing(size_t size);
+		~StagingRing();
+
+		/* Disable copying and moving, the mapping points into the buffer */
+		StagingRing(const StagingRing&) = delete;
+		StagingRing& operator=(const StagingRing&) = delete;
+
+		/* Copy bytes to an offset in another buffer */
+		void Upload(unsigned int buffer, size_t offset, const void* data, size_t size);
+
+		/* Fence the copies issued since the last call, so their bytes can be reused once done */
+		void Fence();
+
+		inline bool IsMapped() const { return m_Mapped != nullptr; }
+		inline size_t GetSize() const { return m_Size; }
+		inline const StagingStats& GetStats() const { return m_Stats; }
+	};
+};
@@ -0,0 +1,173 @@
+#include "state.h"
+
+namespace render {
+	StateCache::StateCache() {
+		Invalidate();
+	}
+
+	StateCache& StateCache::Get() {
+		static StateCache cache;
+		return cache;
+	}
+
+	int StateCache::GetBufferSlot(GLenum target) {
+		switch (target) {
+		case GL_ARRAY_BUFFER: return ARRAY;
+		case GL_ELEMENT_ARRAY_BUFFER: return ELEMENT_ARRAY;
+		case GL_DRAW_INDIRECT_BUFFER: return DRAW_INDIRECT;
+		case GL_UNIFORM_BUFFER: return UNIFORM;
+		case GL_COPY_READ_BUFFER: return COPY_READ;
+		case GL_COPY_WRITE_BUFFER: return COPY_WRITE;
+		case GL_PIXEL_PACK_BUFFER: return PIXEL_PACK;
+		case GL_PIXEL_UNPACK_BUFFER: return PIXEL_UNPACK;
+		}
+
+		return -1;
+	}
+
+	int StateCache::GetTextureSlot(GLenum target) {
+		switch (target) {
+		case GL_TEXTURE_2D: return TEXTURE_2D;
+		case GL_TEXTURE_2D_ARRAY: return TEXTURE_2D_ARRAY;
+		}
+
+		return -1;
+	}
+
+	bool StateCache::Update(unsigned int& cached, unsigned int value) {
+		if (cached == value) {
+			m_Stats.elided++;
+			return false;
+		}
+
+		cached = value;
+		m_Stats.issued++;
+		return true;
+	}
+
+	void StateCache::UseProgram(unsigned int program) {
+		if (Update(m_Program, program)) {
+			glUseProgram(program);
+		}
+	}
+
+	void StateCache::BindVertexArray(unsigned int array) {
+		if (Update(m_VertexArray, array)) {
+			glBindVertexArray(array);
+
+			/* Each vertex array has its own element buffer */
+			m_Buffers[ELEMENT_ARRAY] = UNKNOWN;
+		}
+	}
+
+	void StateCache::BindBuffer(GLenum target, unsigned int buffer) {
+		int slot = GetBufferSlot(target);
+		if (slot == -1) {
+			m_Stats.issued++;
+			glBindBuffer(target, buffer);
+			return;
+		}
+
+		if (Update(m_Buffers[slot], buffer)) {
+			glBindBuffer(target, buffer);
+		}
+	}
+
+	void StateCache::BindBufferBase(GLenum target, unsigned int index, unsigned int buffer) {
+		/* Indexed binds also replace the generic binding */
+		m_Stats.issued++;
+		glBindBufferBase(target, index, buffer);
+
+		int slot = GetBufferSlot(target);
+		if (slot != -1) {
+			m_Buffers[slot] = buffer;
+		}
+	}
+
+	void StateCache::ActiveTexture(unsigned int unit) {
+		if (Update(m_ActiveUnit, unit)) {
+			glActiveTexture(GL_TEXTURE0 + unit);
+		}
+	}
+
+	void StateCache::BindTexture(GLenum target, unsigned int texture) {
+		int slot = GetTextureSlot(target);
+		if (slot == -1 || m_ActiveUnit >= MAX_TEXTURE_UNITS) {
+			m_Stats.issued++;
+			glBindTexture(target, texture);
+			return;
+		}
+
+		if (Update(m_Textures[m_ActiveUnit][slot], texture)) {
+			glBindTexture(target, texture);
+		}
+	}
+
+	void StateCache::BindTexture(unsigned int unit, GLenum target, unsigned int texture) {
+		/* Only switch units when the bind isn't elided */
+		int slot = GetTextureSlot(target);
+		if (slot != -1 && unit < MAX_TEXTURE_UNITS && m_Textures[unit][slot] == texture) {
+			m_Stats.elided++;
+			return;
+		}
+
+		ActiveTexture(unit);
+		BindTexture(target, texture);
+	}
+
+	void StateCache::DeleteProgram(unsigned int program) {
+		glDeleteProgram(program);
+
+		/* A program in use lives on until replaced, so force the next bind through */
+		if (m_Program == program) {
+			m_Program = UNKNOWN;
+		}
+	}
+
+	void StateCache::DeleteVertexArray(unsigned int array) {
+		glDeleteVertexArrays(1, &array);
+
+		if (m_VertexArray == array) {
+			m_VertexArray = 0;
+			m_Buffers[ELEMENT_ARRAY] = 0;
+		}
+	}
+
+	void StateCache::DeleteBuffer(unsigned int buffer) {
+		glDeleteBuffers(1, &buffer);
+
+		for (auto& bound : m_Buffers) {
+			if (bound == buffer) {
+				bound = 0;
+			}
+		}
+	}
+
+	void StateCache::DeleteTexture(unsigned int texture) {
+		glDeleteTextures(1, &texture);
+
+		for (auto& unit : m_Textures) {
+			for (auto& bound : unit) {
+				if (bound == texture) {
+					bound = 0;
+				}
+			}
+		}
+	}
+
+	void StateCache::Invalidate() {
+		m_Program = UNKNOWN;
+		m_VertexArray = UNKNOWN;
+		m_ActiveUnit = UNKNOWN;
+
+		for (auto& bound : m_Buffers) {
+			bound = UNKNOWN;
+		}
+
+		for (auto& unit : m_Textures) {
+			for (auto& bound : unit) {
+				bound = UNKNOWN;
+			}
+		}
+	}
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+
+#include <glad/glad.h>
+
+namespace render {
+	struct StateCacheStats {
+		size_t issued = 0; // Calls that reached GL
+		size_t elided = 0; // Calls skipped because the state was already set
+	};
+
+	/*
+	 * Shadow copy of the bind points the renderer touches, so binding what is
+	 * already bound costs nothing. Every bind in the renderer goes through
+	 * here; code calling GL directly has to Invalidate() afterwards. The
+	 * element array binding belongs to the vertex array, so changing vertex
+	 * arrays forgets it. Deleting an object through the cache clears it from
+	 * any bind point, matching what GL does.
+	 */
+	class StateCache {
+	private:
+		static constexpr unsigned int UNKNOWN = ~0u;
+		static constexpr unsigned int MAX_TEXTURE_UNITS = 32;
+
+		enum BufferTarget {
+			ARRAY,
+			ELEMENT_ARRAY,
+			DRAW_INDIRECT,
+			UNIFORM,
+			COPY_READ,
+			COPY_WRITE,
+			PIXEL_PACK,
+			PIXEL_UNPACK,
+			BUFFER_TARGET_COUNT
+		};
+
+		enum TextureTarget {
+			TEXTURE_2D,
+			TEXTURE_2D_ARRAY,
+			TEXTURE_TARGET_COUNT
+		};
+
+		unsigned int m_Program;
+		unsigned int m_VertexArray;
+		unsigned int m_Buffers[BUFFER_TARGET_COUNT];
+		unsigned int m_ActiveUnit;
+		unsigned int m_Textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+		StateCacheStats m_Stats;
+
+		static int GetBufferSlot(GLenum target);
+		static int GetTextureSlot(GLenum target);
+
+		/* Count and report whether the call must reach GL */
+		bool Update(unsigned int& cached, unsigned int value);
+
+		StateCache();
+
+	public:
+		/* Cache of the one GL context, render thread only */
+		static StateCache& Get();
+
+		/* Binds */
+		void UseProgram(unsigned int program);
+		void BindVertexArray(unsigned int array);
+		void BindBuffer(GLenum target, unsigned int buffer);
+		void BindBufferBase(GLenum target, unsigned int index, unsigned int buffer);
+		void ActiveTexture(unsigned int unit);
+		void BindTexture(GLenum target, unsigned int texture);
+		void BindTexture(unsigned int unit, GLenum target, unsigned int texture);
+
+		/* Delete and forget */
+		void DeleteProgram(unsigned int program);
+		void DeleteVertexArray(unsigned int array);
+		void DeleteBuffer(unsigned int buffer);
+		void DeleteTexture(unsigned int texture);
+
+		/* Forget everything, after GL state changed behind the cache's back */
+		void Invalidate();
+
+		/* Counters */
+		inline const StateCacheStats& GetStats() const { return m_Stats; }
+		inline void ResetStats() { m_Stats = {}; }
+	};
+};
@@ -1,4 +1,5 @@
 #include "textures.h"
+#include "state.h"
 
 #include <iostream>
 
@@ -7,7 +8,7 @@
 namespace render {
 	Texture::Texture() {
 		glGenTextures(1, &m_RendererID);
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 		/* Allocate texture with no data */
 		// glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLenum>(type), width, height, 0, static_cast<GLenum>(type), (type == ComponentType::DEPTH ? GL_FLOAT : GL_UNSIGNED_INT), nullptr);
@@ -16,7 +17,7 @@ namespace render {
 	Texture::Texture(int width, int height, const void* data, ComponentType type) {
 		/* Generate texture */
 		glGenTextures(1, &m_RendererID);
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 		/* Upload texture */
 		glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLenum>(type), width, height, 0, static_cast<GLenum>(type), GL_UNSIGNED_BYTE, data);
@@ -34,7 +35,7 @@ namespace render {
 
 		/* Generate texture */
 		glGenTextures(1, &m_RendererID);
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 		/* Set texture parameters */
 		GLenum format = GL_RGB;
@@ -51,7 +52,7 @@ namespace render {
 
 	Texture::~Texture() {
 		if (m_RendererID) {
-			glDeleteTextures(1, &m_RendererID);
+			StateCache::Get().DeleteTexture(m_RendererID);
 		}
 	}
 
@@ -65,7 +66,7 @@ namespace render {
 	Texture& Texture::operator=(Texture&& other) noexcept {
 		if (this != &other) {
 			if (m_RendererID) {
-				glDeleteTextures(1, &m_RendererID);
+				StateCache::Get().DeleteTexture(m_RendererID);
 			}
 
 			m_RendererID = other.m_RendererID;
@@ -83,12 +84,11 @@ namespace render {
 			return;
 		}
 
-		glActiveTexture(GL_TEXTURE0 + slot);
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(slot, GL_TEXTURE_2D, m_RendererID);
 	}
 
 	void Texture::Unbind() const {
-		glBindTexture(GL_TEXTURE_2D, 0);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, 0);
 	}
 
 	void Texture::SetData(const std::filesystem::path& path) {
@@ -102,7 +102,7 @@ namespace render {
 		}
 
 		/* Bind texture */
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 		/* Set texture parameters */
 		GLenum format = GL_RGB;
@@ -118,26 +118,26 @@ namespace render {
 	}
 
 	void Texture::SetData(int width, int height, const void* data, ComponentType type) {
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 		/* Upload texture */
 		glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLenum>(type), width, height, 0, static_cast<GLenum>(type), (type == ComponentType::DEPTH ? GL_FLOAT : GL_UNSIGNED_INT), data);
 	}
 
 	void Texture::SetWrapMode(WrapMode mode) {
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLenum>(mode));
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLenum>(mode));
 	}
 
 	void Texture::SetFilterMode(FilterMode min, FilterMode mag) {
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, static_cast<GLenum>(min));
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, static_cast<GLenum>(mag));
 	}
 
 	void Texture::GenerateMipmaps(unsigned int levels) {
-		glBindTexture(GL_TEXTURE_2D, m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D, m_RendererID);
 
 		/* Set levels */
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
@@ -160,4 +160,120 @@ namespace render {
 
 		return { x, y, x + width, y + height };
 	}
-};
\ No newline at end of file
+
+	TextureArray::TextureArray(const std::filesystem::path& path, int columns, int rows) : m_RendererID(0), m_Width(0), m_Height(0), m_Layers(0) {
+		stbi_set_flip_vertically_on_load(true);
+
+		/* Load atlas */
+		int width, height, channels;
+		unsigned char* data = stbi_load(path.string().c_str(), &width, &height, &channels, 0);
+		if (!data) {
+			std::cerr << "Failed to load texture: " << path << std::endl;
+			return;
+		}
+
+		if (columns <= 0 || rows <= 0 || width % columns != 0 || height % rows != 0) {
+			std::cerr << "Texture doesn't split into " << columns << "x" << rows << " tiles: " << path << std::endl;
+			stbi_image_free(data);
+			return;
+		}
+
+		m_Width = width / columns;
+		m_Height = height / rows;
+		m_Layers = columns * rows;
+
+		/* Generate texture */
+		glGenTextures(1, &m_RendererID);
+		StateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+
+		GLenum format = GL_RGB;
+		if (channels == 4) {
+			format = GL_RGBA;
+		}
+
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, format, m_Width, m_Height, m_Layers, 0, format, GL_UNSIGNED_BYTE, nullptr);
+
+		/* Upload each tile straight out of the atlas, the image is flipped so the top row of tiles comes last */
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, width);
+
+		for (int layer = 0; layer < m_Layers; layer++) {
+			int column = layer % columns;
+			int row = rows - 1 - layer / columns;
+
+			const unsigned char* tile = data + (static_cast<size_t>(row) * m_Height * width + static_cast<size_t>(column) * m_Width) * channels;
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, format, GL_UNSIGNED_BYTE, tile);
+		}
+
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		stbi_image_free(data);
+	}
+
+	TextureArray::~TextureArray() {
+		if (m_RendererID) {
+			StateCache::Get().DeleteTexture(m_RendererID);
+		}
+	}
+
+	TextureArray::TextureArray(TextureArray&& other) noexcept {
+		m_RendererID = other.m_RendererID;
+		m_Width = other.m_Width;
+		m_Height = other.m_Height;
+		m_Layers = other.m_Layers;
+		other.m_RendererID = 0;
+	}
+
+	TextureArray& TextureArray::operator=(TextureArray&& other) noexcept {
+		if (this != &other) {
+			if (m_RendererID) {
+				StateCache::Get().DeleteTexture(m_RendererID);
+			}
+
+			m_RendererID = other.m_RendererID;
+			m_Width = other.m_Width;
+			m_Height = other.m_Height;
+			m_Layers = other.m_Layers;
+			other.m_RendererID = 0;
+		}
+
+		return *this;
+	}
+
+	void TextureArray::Bind(unsigned int slot) const {
+		if (slot >= 32) {
+			std::cerr << "Texture slot out of range: " << slot << std::endl;
+			return;
+		}
+
+		StateCache::Get().BindTexture(slot, GL_TEXTURE_2D_ARRAY, m_RendererID);
+	}
+
+	void TextureArray::Unbind() const {
+		StateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	}
+
+	void TextureArray::SetWrapMode(WrapMode mode) {
+		StateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, static_cast<GLenum>(mode));
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, static_cast<GLenum>(mode));
+	}
+
+	void TextureArray::SetFilterMode(FilterMode min, FilterMode mag) {
+		StateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, static_cast<GLenum>(min));
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, static_cast<GLenum>(mag));
+	}
+
+	void TextureArray::GenerateMipmaps(unsigned int levels) {
+		StateCache::Get().BindTexture(GL_TEXTURE_2D_ARRAY, m_RendererID);
+
+		/* Set levels */
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels);
+
+		/* Generate mipmaps, layers are filtered independently */
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	}
+};
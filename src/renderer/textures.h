@@ -77,4 +77,45 @@ namespace render {
 		inline int GetHeight() const { return m_Height; }
 		inline int GetChannels() const { return m_Channels; }
 	};
-};
\ No newline at end of file
+
+	/*
+	 * Equally sized tiles of an atlas image, one per layer. Layers are
+	 * numbered row by row from the top left tile, and each one wraps and
+	 * mipmaps on its own, so tiles never bleed into each other.
+	 */
+	class TextureArray {
+	private:
+		unsigned int m_RendererID;
+		int m_Width, m_Height, m_Layers;
+	public:
+		TextureArray(const std::filesystem::path& path, int columns, int rows);
+		~TextureArray();
+
+		/* Disable copying */
+		TextureArray(const TextureArray&) = delete;
+		TextureArray& operator=(const TextureArray&) = delete;
+
+		/* Enable moving */
+		TextureArray(TextureArray&& other) noexcept;
+		TextureArray& operator=(TextureArray&& other) noexcept;
+
+		/* Get renderer ID */
+		inline unsigned int GetRendererID() const { return m_RendererID; }
+
+		/* Bind and unbind */
+		void Bind(unsigned int slot = 0) const;
+		void Unbind() const;
+
+		/* Wrap and filter modes */
+		void SetWrapMode(WrapMode mode);
+		void SetFilterMode(FilterMode min, FilterMode mag);
+
+		/* Mipmaps */
+		void GenerateMipmaps(unsigned int levels = 4);
+
+		/* Getters, sizes are per layer */
+		inline int GetWidth() const { return m_Width; }
+		inline int GetHeight() const { return m_Height; }
+		inline int GetLayerCount() const { return m_Layers; }
+	};
+};
@@ -0,0 +1,513 @@
+#include "streaming.h"
+
+#include <chrono>
+#include <algorithm>
+
+/* Chunks closer than this load first whichever way the camera faces */
+constexpr float NEARBY_DISTANCE = 2.0f;
+
+/* Turning further than this (cosine of about 25 degrees) reorders the queue */
+constexpr float VIEW_REORDER_DOT = 0.9f;
+
+ChunkStreamer::ChunkStreamer(World& world, ChunkWorkerPool& workers, render::GeometryArena& arena, ChunkCache& cache, ChunkStorage* storage, const WorldSettings& settings, const UploadBudget& budget, size_t max_in_flight)
+	: m_World(world), m_Workers(workers), m_Arena(arena), m_Cache(cache), m_Storage(storage), m_Settings(settings), m_Mode(MeshingMode::NAIVE),
+	  m_Budget(budget), m_UploadCount(0), m_UploadBytes(0), m_UploadMilliseconds(0.0f), m_Center(0), m_View(0.0f), m_Started(false), m_MaxInFlight(max_in_flight), m_InFlight(0), m_Cancelled(0), m_Discarded(0) {
+	/* Unloading inside the render distance would drop chunks it asks for right away */
+	m_Settings.unload_distance = std::max(m_Settings.unload_distance, m_Settings.render_distance);
+
+	/* Keep the workers busy without queueing more than can be reordered or cancelled */
+	if (m_MaxInFlight == 0) {
+		m_MaxInFlight = m_Workers.GetThreadCount() * 2;
+	}
+
+	int distance = m_Settings.render_distance;
+	for (int offset_x = -distance; offset_x < distance; offset_x++) {
+		for (int offset_z = -distance; offset_z < distance; offset_z++) {
+			if (IsInRange(glm::ivec2(offset_x, offset_z))) {
+				m_Offsets.push_back(glm::ivec2(offset_x, offset_z));
+			}
+		}
+	}
+
+	std::stable_sort(m_Offsets.begin(), m_Offsets.end(), [](glm::ivec2 a, glm::ivec2 b) {
+		return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+	});
+}
+
+bool ChunkStreamer::CompareCandidates(const Candidate& a, const Candidate& b) {
+	/* Heap functions keep the largest on top, flip it so the lowest priority goes first */
+	return a.priority > b.priority;
+}
+
+bool ChunkStreamer::IsWithin(glm::ivec2 offset, int distance) {
+	if (offset.x < -distance || offset.x >= distance || offset.y < -distance || offset.y >= distance) {
+		return false;
+	}
+
+	return offset.x * offset.x + offset.y * offset.y < distance * distance;
+}
+
+bool ChunkStreamer::IsInRange(glm::ivec2 offset) const {
+	return IsWithin(offset, m_Settings.render_distance);
+}
+
+bool ChunkStreamer::IsInUnloadRange(glm::ivec2 offset) const {
+	return IsWithin(offset, m_Settings.unload_distance);
+}
+
+uint8_t ChunkStreamer::GetNeighboursInRange(glm::ivec2 position) const {
+	uint8_t neighbours = 0;
+	for (int side = 0; side < CHUNK_NEIGHBOUR_COUNT; side++) {
+		if (IsInRange(GetChunkNeighbour(position, side) - m_Center)) {
+			neighbours |= 1u << side;
+		}
+	}
+
+	return neighbours;
+}
+
+float ChunkStreamer::GetPriority(glm::ivec2 position) const {
+	glm::vec2 offset = glm::vec2(position - m_Center);
+	float distance = glm::length(offset);
+	if (distance < NEARBY_DISTANCE) {
+		return distance;
+	}
+
+	/* Straight ahead counts its distance, straight behind twice that */
+	float facing = glm::dot(offset / distance, m_View);
+	return distance * (1.5f - 0.5f * facing);
+}
+
+ChunkStreamer::Record* ChunkStreamer::FindRecord(glm::ivec2 position) {
+	auto it = m_Records.find(PackChunkKey(position));
+	return it != m_Records.end() ? &it->second : nullptr;
+}
+
+void ChunkStreamer::Enqueue(Record& record) {
+	record.queued = true;
+	m_Queue.push_back({ GetPriority(record.position), record.position });
+	std::push_heap(m_Queue.begin(), m_Queue.end(), CompareCandidates);
+}
+
+void ChunkStreamer::RebuildQueue() {
+	/* Drop entries of chunks that were forgotten and score the rest for the new position and view */
+	size_t kept = 0;
+	for (const Candidate& candidate : m_Queue) {
+		const Record* record = FindRecord(candidate.position);
+		if (record != nullptr && record->queued) {
+			m_Queue[kept++] = { GetPriority(candidate.position), candidate.position };
+		}
+	}
+
+	m_Queue.resize(kept);
+	std::make_heap(m_Queue.begin(), m_Queue.end(), CompareCandidates);
+}
+
+bool ChunkStreamer::NeedsMesh(const Record& record, const Chunk& chunk) const {
+	if (!chunk.HasMesh() || record.mode != m_Mode) {
+		return true;
+	}
+
+	/* Losing a neighbour leaves its border culled, which is fine at the edge of the world */
+	uint8_t loaded = GetChunkNeighbours(m_World.GetChunks(), chunk.GetPosition());
+	return (loaded & ~chunk.GetMeshNeighbours()) != 0;
+}
+
+bool ChunkStreamer::IsMeshCurrent(const ChunkMeshData& mesh, const Chunk& chunk) const {
+	if (mesh.revision != chunk.GetRevision() || mesh.mode != m_Mode) {
+		return false;
+	}
+
+	/* A neighbour edited since, maybe while this chunk sat in the cache, leaves its border faces wrong */
+	for (int side = 0; side < CHUNK_NEIGHBOUR_COUNT; side++) {
+		const Chunk* neighbour = (mesh.neighbours >> side) & 1 ? m_World.GetChunks().Find(GetChunkNeighbour(chunk.GetPosition(), side)) : nullptr;
+		if (neighbour != nullptr && neighbour->GetRevision() != mesh.neighbourRevisions[side]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ChunkStreamer::IsReadyToMesh(glm::ivec2 position) const {
+	/* Neighbours out of range read as air, the chunk is meshed again if they turn up later */
+	uint8_t loaded = GetChunkNeighbours(m_World.GetChunks(), position);
+	return (GetNeighboursInRange(position) & ~loaded) == 0;
+}
+
+void ChunkStreamer::Evaluate(Record& record) {
+	if (record.state != ChunkState::GENERATED && record.state != ChunkState::UPLOADED && record.state != ChunkState::RESIDENT) {
+		return;
+	}
+
+	const Chunk* chunk = m_World.GetChunks().Find(record.position);
+	if (chunk == nullptr) {
+		return;
+	}
+
+	if (chunk->HasMesh()) {
+		uint8_t missing = GetNeighboursInRange(record.position) & ~chunk->GetMeshNeighbours();
+		record.state = missing == 0 && record.mode == m_Mode ? ChunkState::RESIDENT : ChunkState::UPLOADED;
+	}
+
+	if (!record.queued && NeedsMesh(record, *chunk) && IsReadyToMesh(record.position)) {
+		Enqueue(record);
+	}
+}
+
+void ChunkStreamer::EvaluateNeighbours(glm::ivec2 position) {
+	for (int side = 0; side < CHUNK_NEIGHBOUR_COUNT; side++) {
+		Record* neighbour = FindRecord(GetChunkNeighbour(position, side));
+		if (neighbour != nullptr) {
+			Evaluate(*neighbour);
+		}
+	}
+}
+
+void ChunkStreamer::Request(Record& record) {
+	record.state = ChunkState::REQUESTED;
+	if (!m_Cache.Contains(record.position) || !Restore(record)) {
+		Enqueue(record);
+	}
+}
+
+bool ChunkStreamer::Restore(Record& record) {
+	ChunkMeshData mesh;
+	std::optional<Chunk> chunk = m_Cache.Take(record.position, &mesh);
+	if (!chunk.has_value()) {
+		return false;
+	}
+
+	m_World.GetChunks().Insert(std::move(*chunk));
+
+	/* A cached mesh goes through the upload queue like a fresh one and is checked against the revisions there */
+	if (!mesh.sections.empty()) {
+		record.state = ChunkState::MESHING;
+		m_Uploads.push_back({ record.position, std::move(mesh) });
+		return true;
+	}
+
+	record.state = ChunkState::GENERATED;
+	Evaluate(record);
+	EvaluateNeighbours(record.position);
+	return true;
+}
+
+void ChunkStreamer::Unload(Record& record) {
+	ChunkMap& chunks = m_World.GetChunks();
+	Chunk* chunk = chunks.Find(record.position);
+	if (chunk == nullptr) {
+		return;
+	}
+
+	Store(std::move(*chunk), std::move(record.mesh));
+	chunks.Erase(record.position);
+}
+
+void ChunkStreamer::Store(Chunk&& chunk, ChunkMeshData&& mesh) {
+	/* Saved before the cache can evict it, the cache never holds the only copy of an edit */
+	if (m_Storage != nullptr && !chunk.IsSaved()) {
+		m_Storage->Save(chunk);
+		chunk.MarkSaved();
+	}
+
+	m_Cache.Insert(std::move(chunk), std::move(mesh));
+}
+
+void ChunkStreamer::Recenter(glm::ivec2 center) {
+	m_Center = center;
+
+	/* Let go of everything that left the unload distance, cancelling work no worker has started */
+	bool dropped_uploads = false;
+	for (auto it = m_Records.begin(); it != m_Records.end();) {
+		Record& record = it->second;
+		if (IsInRange(record.position - m_Center)) {
+			++it;
+			continue;
+		}
+
+		/* Requests are cheap to make again, anything further along is kept until the unload distance */
+		if (record.state == ChunkState::REQUESTED) {
+			m_Cancelled++;
+			it = m_Records.erase(it);
+			continue;
+		}
+
+		if (IsInUnloadRange(record.position - m_Center)) {
+			++it;
+			continue;
+		}
+
+		bool forget = true;
+		switch (record.state) {
+		case ChunkState::GENERATING:
+		case ChunkState::MESHING:
+			Unload(record);
+			if (!m_Workers.IsPending(record.position)) {
+				/* Meshed and waiting to be uploaded, the upload is dropped below */
+				dropped_uploads = true;
+			} else if (m_Workers.Cancel(record.position)) {
+				m_InFlight--;
+				m_Cancelled++;
+			} else {
+				/* Already running, its result is dropped when it comes back */
+				record.state = ChunkState::UNLOADING;
+				forget = false;
+			}
+			break;
+		case ChunkState::UNLOADING:
+			forget = false;
+			break;
+		default:
+			Unload(record);
+			break;
+		}
+
+		it = forget ? m_Records.erase(it) : std::next(it);
+	}
+
+	if (dropped_uploads) {
+		auto forgotten = [this](const PendingUpload& upload) { return FindRecord(upload.position) == nullptr; };
+		size_t before = m_Uploads.size();
+		m_Uploads.erase(std::remove_if(m_Uploads.begin(), m_Uploads.end(), forgotten), m_Uploads.end());
+		m_Discarded += before - m_Uploads.size();
+	}
+
+	/* Request everything that came into range */
+	for (glm::ivec2 offset : m_Offsets) {
+		glm::ivec2 position = m_Center + offset;
+		auto [it, inserted] = m_Records.try_emplace(PackChunkKey(position), Record{ position, ChunkState::REQUESTED, false, m_Mode, {} });
+		if (inserted) {
+			Request(it->second);
+		}
+	}
+
+	/* Neighbours moving in or out of range can make loaded chunks ready or final */
+	for (auto& [key, record] : m_Records) {
+		Evaluate(record);
+	}
+}
+
+void ChunkStreamer::Collect() {
+	ChunkMap& chunks = m_World.GetChunks();
+
+	m_Workers.Collect([&](ChunkBuildResult&& result) {
+		glm::ivec2 position = result.position;
+		m_InFlight--;
+
+		/* Only unloading chunks can be this far with a task running, freshly generated blocks are still worth caching */
+		Record* record = FindRecord(position);
+		if (record == nullptr || !IsInUnloadRange(position - m_Center)) {
+			if (result.type == ChunkTaskType::GENERATE) {
+				Store(std::move(*result.chunk));
+			}
+
+			m_Records.erase(PackChunkKey(position));
+			m_Discarded++;
+			return;
+		}
+
+		if (result.type == ChunkTaskType::GENERATE) {
+			chunks.Insert(std::move(*result.chunk));
+			record->state = ChunkState::GENERATED;
+
+			/* The new chunk and the ones next to it may now have every neighbour they need */
+			Evaluate(*record);
+			EvaluateNeighbours(position);
+			return;
+		}
+
+		/* Unloaded while meshing and back before the mesh was, the chunk waits in the cache */
+		Chunk* chunk = chunks.Find(position);
+		if (record->state == ChunkState::UNLOADING || chunk == nullptr) {
+			m_Discarded++;
+			if (IsInRange(position - m_Center)) {
+				Request(*record);
+			} else {
+				m_Records.erase(PackChunkKey(position));
+			}
+
+			return;
+		}
+
+		m_Uploads.push_back({ position, std::move(result.mesh) });
+	});
+}
+
+void ChunkStreamer::Upload() {
+	ChunkMap& chunks = m_World.GetChunks();
+	auto start = std::chrono::steady_clock::now();
+	auto elapsed = [start] {
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	};
+
+	m_UploadCount = 0;
+	m_UploadBytes = 0;
+
+	while (!m_Uploads.empty()) {
+		PendingUpload& upload = m_Uploads.front();
+		const size_t size = upload.mesh.GetSize();
+
+		/* Blocks edited since it was meshed or a mode switch make the mesh stale, it's queued again by Evaluate */
+		Record* record = FindRecord(upload.position);
+		Chunk* chunk = chunks.Find(upload.position);
+		const bool current = record != nullptr && chunk != nullptr && IsMeshCurrent(upload.mesh, *chunk);
+
+		/* Stale meshes cost nothing, only uploads count against the budget */
+		if (current && m_UploadCount > 0) {
+			if (m_Budget.bytes > 0 && m_UploadBytes + size > m_Budget.bytes) {
+				break;
+			}
+
+			if (m_Budget.milliseconds > 0.0f && elapsed() >= m_Budget.milliseconds) {
+				break;
+			}
+		}
+
+		if (record != nullptr && chunk != nullptr) {
+			if (current) {
+				UploadChunkMesh(m_Arena, *chunk, upload.mesh);
+				record->mode = upload.mesh.mode;
+				m_UploadCount++;
+				m_UploadBytes += size;
+
+				/* Handed to the cache with the chunk when it's unloaded */
+				if (m_Cache.KeepsMeshes()) {
+					std::swap(record->mesh, upload.mesh);
+				}
+			}
+
+			record->state = chunk->HasMesh() ? ChunkState::UPLOADED : ChunkState::GENERATED;
+			Evaluate(*record);
+		}
+
+		/* Uploaded, stale or replaced by the copy kept for the cache, the workers build into its arrays next */
+		if (!upload.mesh.sections.empty()) {
+			m_Workers.Recycle(std::move(upload.mesh));
+		}
+
+		m_Uploads.pop_front();
+	}
+
+	m_UploadMilliseconds = elapsed();
+}
+
+void ChunkStreamer::Dispatch() {
+	ChunkMap& chunks = m_World.GetChunks();
+
+	while (m_InFlight < m_MaxInFlight && !m_Queue.empty()) {
+		std::pop_heap(m_Queue.begin(), m_Queue.end(), CompareCandidates);
+		glm::ivec2 position = m_Queue.back().position;
+		m_Queue.pop_back();
+
+		Record* record = FindRecord(position);
+		if (record == nullptr || !record->queued) {
+			continue;
+		}
+
+		record->queued = false;
+		if (record->state == ChunkState::REQUESTED) {
+			/* The cache counts a miss for every chunk that has to be generated */
+			if (Restore(*record)) {
+				continue;
+			}
+
+			m_Workers.Request(position);
+			record->state = ChunkState::GENERATING;
+			m_InFlight++;
+			continue;
+		}
+
+		/* Meshes are checked again, a neighbour may have left the range since they were queued */
+		const Chunk* chunk = chunks.Find(position);
+		if (chunk == nullptr || record->state == ChunkState::GENERATING || record->state == ChunkState::MESHING || record->state == ChunkState::UNLOADING) {
+			continue;
+		}
+
+		if (NeedsMesh(*record, *chunk) && IsReadyToMesh(position) && m_Workers.Mesh(*chunk, GetChunkBorders(chunks, position), m_Mode)) {
+			record->state = ChunkState::MESHING;
+			m_InFlight++;
+		}
+	}
+}
+
+void ChunkStreamer::Update(glm::vec3 position, glm::vec3 direction, MeshingMode mode) {
+	glm::ivec2 center = glm::ivec2(glm::floor(glm::vec2(position.x, position.z) / static_cast<float>(m_Settings.chunk_width)));
+
+	/* Looking straight up or down has no horizontal direction, only distance counts then */
+	glm::vec2 view = glm::vec2(direction.x, direction.z);
+	float length = glm::length(view);
+	view = length > 0.001f ? view / length : glm::vec2(0.0f);
+
+	bool reorder = false;
+	if (view != m_View && glm::dot(view, m_View) < VIEW_REORDER_DOT) {
+		m_View = view;
+		reorder = true;
+	}
+
+	if (!m_Started || center != m_Center) {
+		m_Started = true;
+		Recenter(center);
+		reorder = true;
+	}
+
+	/* Every loaded chunk is meshed again in the new mode, Upload drops meshes still on their way from the old one */
+	if (mode != m_Mode) {
+		m_Mode = mode;
+		for (auto& [key, record] : m_Records) {
+			Evaluate(record);
+		}
+	}
+
+	if (reorder) {
+		RebuildQueue();
+	}
+
+	Collect();
+	Upload();
+	Dispatch();
+}
+
+void ChunkStreamer::SaveAll() {
+	if (m_Storage == nullptr) {
+		return;
+	}
+
+	ChunkMap& chunks = m_World.GetChunks();
+	for (auto& [key, record] : m_Records) {
+		Chunk* chunk = chunks.Find(record.position);
+		if (chunk != nullptr && !chunk->IsSaved()) {
+			m_Storage->Save(*chunk);
+			chunk->MarkSaved();
+		}
+	}
+}
+
+bool ChunkStreamer::GetState(glm::ivec2 position, ChunkState& state) const {
+	auto it = m_Records.find(PackChunkKey(position));
+	if (it == m_Records.end()) {
+		return false;
+	}
+
+	state = it->second.state;
+	return true;
+}
+
+StreamingStats ChunkStreamer::GetStats() const {
+	StreamingStats stats;
+	for (const auto& [key, record] : m_Records) {
+		stats.chunks[static_cast<int>(record.state)]++;
+		if (record.queued) {
+			stats.queued++;
+		}
+	}
+
+	stats.inFlight = m_InFlight;
+	stats.cancelled = m_Cancelled;
+	stats.discarded = m_Discarded;
+	stats.pendingUploads = m_Uploads.size();
+	stats.uploads = m_UploadCount;
+	stats.uploadBytes = m_UploadBytes;
+	stats.uploadMilliseconds = m_UploadMilliseconds;
+	return stats;
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+#include <renderer/arena.h>
+
+#include "world.h"
+#include "chunks.h"
+#include "meshing.h"
+#include "workers.h"
+#include "cache.h"
+#include "region.h"
+
+/*
+ * Where a chunk is on its way in or out. A chunk moves forward one step at a
+ * time: requested chunks wait for a worker, generated chunks wait for their
+ * neighbours, and uploaded chunks become resident once they have been meshed
+ * against every neighbour in range. Uploaded and resident chunks go back to
+ * meshing when a neighbour arrives they weren't culled against, or when the
+ * meshing mode changes.
+ */
+enum class ChunkState {
+	REQUESTED = 0, // Wanted, waiting in the queue for a worker
+	GENERATING,    // Generation task queued or running
+	GENERATED,     // Blocks loaded, no mesh yet
+	MESHING,       // Mesh task queued or running, or its mesh waiting to be uploaded
+	UPLOADED,      // Drawn, but meshed before every neighbour in range was loaded or in another meshing mode
+	RESIDENT,      // Drawn and final until its blocks change
+	UNLOADING,     // Left the unload distance with a task running, forgotten once the task comes back
+};
+
+constexpr int CHUNK_STATE_COUNT = 7;
+
+struct StreamingStats {
+	std::array<size_t, CHUNK_STATE_COUNT> chunks{}; // Chunks in each state
+	size_t queued = 0;    // Requests and meshes waiting for a worker
+	size_t inFlight = 0;  // Tasks handed to the workers and not collected yet
+	size_t cancelled = 0; // Requests dropped before they finished, since start
+	size_t discarded = 0; // Finished tasks thrown away because their chunk left the range, since start
+
+	/* Mesh uploads */
+	size_t pendingUploads = 0;    // Meshes waiting for a later frame's budget
+	size_t uploads = 0;           // Meshes uploaded by the last update
+	size_t uploadBytes = 0;       // Bytes they took
+	float uploadMilliseconds = 0; // Time it took
+};
+
+/* Mesh uploads allowed per frame, zero means no limit. One mesh always goes through, however big */
+struct UploadBudget {
+	size_t bytes = 0;
+	float milliseconds = 0.0f;
+};
+
+/*
+ * Loads the chunks around the player through the worker pool and unloads
+ * the ones that leave the unload distance. Chunks between the two stay as
+ * they are, so moving back and forth across a chunk border doesn't unload
+ * and reload the same row. Unloaded chunks go to a ChunkCache and are
+ * taken back from it instead of being generated again. With storage,
+ * chunks with unsaved changes are saved on their way into the cache, so
+ * chunks the cache evicts are read back from disk rather than generated
+ * again. Work waits in a priority queue, nearest first with chunks in
+ * front of the camera ahead of those behind it, and only a few tasks are
+ * handed to the workers at a time. Jumping somewhere new therefore starts
+ * on the chunks that matter right away instead of behind a backlog, and
+ * requests that fall out of range are dropped before any work is spent on
+ * them. The queue is only reordered when the player changes chunk or
+ * turns, so a frame with nothing new costs almost nothing. Finished
+ * meshes are uploaded within a per frame budget, the rest wait for the
+ * next frame, so a burst of meshes arriving at once spreads over a few
+ * frames instead of making one long.
+ */
+class ChunkStreamer {
+private:
+	struct Record {
+		glm::ivec2 position;
+		ChunkState state;
+		bool queued;        // Has an entry in the queue
+		MeshingMode mode;   // Mode of the mesh the chunk is drawn with
+		ChunkMeshData mesh; // Last full mesh uploaded, only kept when the cache keeps meshes
+	};
+
+	struct Candidate {
+		float priority; // Lower goes first
+		glm::ivec2 position;
+	};
+
+	struct PendingUpload {
+		glm::ivec2 position;
+		ChunkMeshData mesh;
+	};
+
+	World& m_World;
+	ChunkWorkerPool& m_Workers;
+	render::GeometryArena& m_Arena;
+	ChunkCache& m_Cache;
+	ChunkStorage* m_Storage;
+	WorldSettings m_Settings;
+	MeshingMode m_Mode;
+
+	std::unordered_map<uint64_t, Record> m_Records;
+	std::vector<Candidate> m_Queue; // Min heap on priority
+	std::vector<glm::ivec2> m_Offsets; // Offsets in range, nearest first
+	std::deque<PendingUpload> m_Uploads; // Finished meshes in completion order
+
+	UploadBudget m_Budget;
+	size_t m_UploadCount;
+	size_t m_UploadBytes;
+	float m_UploadMilliseconds;
+
+	glm::ivec2 m_Center;
+	glm::vec2 m_View;      // Horizontal view direction the queue was ordered for
+	bool m_Started;
+	size_t m_MaxInFlight;
+	size_t m_InFlight;
+	size_t m_Cancelled;
+	size_t m_Discarded;
+
+	static bool CompareCandidates(const Candidate& a, const Candidate& b);
+
+	static bool IsWithin(glm::ivec2 offset, int distance);
+	bool IsInRange(glm::ivec2 offset) const;
+	bool IsInUnloadRange(glm::ivec2 offset) const;
+	uint8_t GetNeighboursInRange(glm::ivec2 position) const;
+	float GetPriority(glm::ivec2 position) const;
+
+	Record* FindRecord(glm::ivec2 position);
+	void Enqueue(Record& record);
+	void RebuildQueue();
+
+	/* Work out whether a loaded chunk is final or has to be meshed (again) and queue it if it can be */
+	void Evaluate(Record& record);
+	void EvaluateNeighbours(glm::ivec2 position);
+	bool NeedsMesh(const Record& record, const Chunk& chunk) const;
+
+	/* Built from the chunk's blocks and its loaded neighbours' as they are now, in the current mode */
+	bool IsMeshCurrent(const ChunkMeshData& mesh, const Chunk& chunk) const;
+	bool IsReadyToMesh(glm::ivec2 position) const;
+
+	/* Restore a chunk from the cache, or queue generating it */
+	void Request(Record& record);
+	bool Restore(Record& record);
+
+	/* Move a loaded chunk from the world into the cache */
+	void Unload(Record& record);
+	void Store(Chunk&& chunk, ChunkMeshData&& mesh = {});
+
+	void Recenter(glm::ivec2 center);
+	void Collect();
+	void Upload();
+	void Dispatch();
+
+public:
+	/* Storage may be null to keep nothing on disk. Zero in flight keeps two tasks per worker thread */
+	ChunkStreamer(World& world, ChunkWorkerPool& workers, render::GeometryArena& arena, ChunkCache& cache, ChunkStorage* storage, const WorldSettings& settings, const UploadBudget& budget = {}, size_t max_in_flight = 0);
+
+	/* Delete copying */
+	ChunkStreamer(const ChunkStreamer&) = delete;
+	ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+	/* Once per frame, render thread only. A new mode remeshes every loaded chunk, meshes built in the old one are dropped */
+	void Update(glm::vec3 position, glm::vec3 direction, MeshingMode mode);
+
+	/* Save every loaded chunk with unsaved changes, before shutting down */
+	void SaveAll();
+
+	/* Mode of the last update, edits should be meshed in it */
+	inline MeshingMode GetMode() const { return m_Mode; }
+
+	inline void SetUploadBudget(const UploadBudget& budget) { m_Budget = budget; }
+	inline const UploadBudget& GetUploadBudget() const { return m_Budget; }
+
+	/* Chunks that aren't tracked are unloaded */
+	bool GetState(glm::ivec2 position, ChunkState& state) const;
+	StreamingStats GetStats() const;
+};
@@ -0,0 +1,140 @@
+#include "workers.h"
+
+#include <algorithm>
+
+/* Meshes kept for recycling per worker thread, enough to cover the meshes in flight and waiting for upload */
+constexpr size_t RECYCLED_MESHES_PER_THREAD = 4;
+
+ChunkWorkerPool::ChunkWorkerPool(ChunkGeneratorFn generator, const WorldSettings& settings, size_t threads, ChunkStorage* storage)
+	: m_Generator(std::move(generator)), m_Settings(settings), m_Storage(storage), m_Stopping(false) {
+	if (threads == 0) {
+		/* hardware_concurrency may report zero when unknown */
+		unsigned int cores = std::thread::hardware_concurrency();
+		threads = cores > 1 ? cores - 1 : 1;
+	}
+
+	for (size_t i = 0; i < threads; i++) {
+		m_Threads.emplace_back(&ChunkWorkerPool::WorkerLoop, this);
+	}
+}
+
+ChunkWorkerPool::~ChunkWorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_TaskMutex);
+		m_Stopping = true;
+		m_Tasks.clear();
+	}
+
+	m_TaskCondition.notify_all();
+	for (auto& thread : m_Threads) {
+		thread.join();
+	}
+}
+
+void ChunkWorkerPool::Request(glm::ivec2 position) {
+	if (!m_Pending.insert(PackChunkKey(position)).second) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_TaskMutex);
+		m_Tasks.push_back({ ChunkTaskType::GENERATE, position, MeshingMode::NAIVE, std::nullopt, {} });
+	}
+
+	m_TaskCondition.notify_one();
+}
+
+bool ChunkWorkerPool::Mesh(const Chunk& chunk, ChunkBorders&& borders, MeshingMode mode) {
+	if (!m_Pending.insert(PackChunkKey(chunk.GetPosition())).second) {
+		return false;
+	}
+
+	/* The loaded chunk stays on the render thread, the worker meshes a copy of its packed sections */
+	Task task{ ChunkTaskType::MESH, chunk.GetPosition(), mode, chunk.CopyBlocks(), std::move(borders) };
+
+	{
+		std::lock_guard<std::mutex> lock(m_TaskMutex);
+		m_Tasks.push_back(std::move(task));
+	}
+
+	m_TaskCondition.notify_one();
+	return true;
+}
+
+bool ChunkWorkerPool::Cancel(glm::ivec2 position) {
+	if (m_Pending.count(PackChunkKey(position)) == 0) {
+		return false;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_TaskMutex);
+		auto it = std::find_if(m_Tasks.begin(), m_Tasks.end(), [position](const Task& task) { return task.position == position; });
+		if (it == m_Tasks.end()) {
+			return false;
+		}
+
+		m_Tasks.erase(it);
+	}
+
+	m_Pending.erase(PackChunkKey(position));
+	return true;
+}
+
+bool ChunkWorkerPool::IsPending(glm::ivec2 position) const {
+	return m_Pending.count(PackChunkKey(position)) != 0;
+}
+
+void ChunkWorkerPool::Recycle(ChunkMeshData&& mesh) {
+	std::lock_guard<std::mutex> lock(m_RecycleMutex);
+	if (m_Recycled.size() < m_Threads.size() * RECYCLED_MESHES_PER_THREAD) {
+		m_Recycled.push_back(std::move(mesh));
+	}
+}
+
+void ChunkWorkerPool::WorkerLoop() {
+	for (;;) {
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(m_TaskMutex);
+			m_TaskCondition.wait(lock, [this] { return m_Stopping || !m_Tasks.empty(); });
+
+			if (m_Stopping) {
+				return;
+			}
+
+			task = std::move(m_Tasks.front());
+			m_Tasks.pop_front();
+		}
+
+		/* Generate or mesh without holding any lock */
+		if (task.type == ChunkTaskType::GENERATE) {
+			/* Saved chunks come back from disk, matching what's there already */
+			std::vector<BlockType> blocks;
+			const bool loaded = m_Storage != nullptr && m_Storage->Load(task.position, blocks);
+			if (!loaded) {
+				blocks = m_Generator(task.position, m_Settings.chunk_width, m_Settings.chunk_height, m_Settings.chunk_depth);
+			}
+
+			Chunk chunk(task.position, blocks, m_Settings.chunk_width, m_Settings.chunk_height, m_Settings.chunk_depth);
+			if (loaded) {
+				chunk.MarkSaved();
+			}
+
+			m_Results.Push({ ChunkTaskType::GENERATE, task.position, std::move(chunk), {} });
+			continue;
+		}
+
+		ChunkMeshData mesh;
+		{
+			std::lock_guard<std::mutex> lock(m_RecycleMutex);
+			if (!m_Recycled.empty()) {
+				mesh = std::move(m_Recycled.back());
+				m_Recycled.pop_back();
+			}
+		}
+
+		/* The copy carries the revision, so the mesh does too */
+		BuildChunkMesh(*task.chunk, task.borders, task.mode, ALL_SECTIONS, mesh);
+		m_Results.Push({ ChunkTaskType::MESH, task.position, std::nullopt, std::move(mesh) });
+	}
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <unordered_set>
+#include <condition_variable>
+
+#include "world.h"
+#include "chunks.h"
+#include "meshing.h"
+#include "region.h"
+
+/*
+ * Lock-free multiple producer, single consumer queue. Producers push with a
+ * single compare and swap onto an intrusive stack; the consumer detaches the
+ * whole stack with one exchange and reverses it, so items still come out in
+ * the order they were pushed. Detaching everything at once means a node is
+ * never popped while another thread looks at it, so there is no ABA problem.
+ */
+template <typename T>
+class CompletionQueue {
+private:
+	struct Node {
+		T value;
+		Node* next;
+	};
+
+	std::atomic<Node*> m_Head;
+
+public:
+	CompletionQueue() : m_Head(nullptr) {}
+	~CompletionQueue() {
+		Drain([](T&&) {});
+	}
+
+	/* Delete copying */
+	CompletionQueue(const CompletionQueue&) = delete;
+	CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+	/* Any thread */
+	void Push(T&& value) {
+		Node* node = new Node{ std::move(value), m_Head.load(std::memory_order_relaxed) };
+		while (!m_Head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {}
+	}
+
+	/* Consumer thread only, calls fn for every item in push order and returns the count */
+	template <typename Fn>
+	size_t Drain(Fn&& fn) {
+		Node* node = m_Head.exchange(nullptr, std::memory_order_acquire);
+
+		/* Reverse into push order */
+		Node* ordered = nullptr;
+		while (node != nullptr) {
+			Node* next = node->next;
+			node->next = ordered;
+			ordered = node;
+			node = next;
+		}
+
+		size_t count = 0;
+		while (ordered != nullptr) {
+			Node* next = ordered->next;
+			fn(std::move(ordered->value));
+			delete ordered;
+			ordered = next;
+			count++;
+		}
+
+		return count;
+	}
+
+	inline bool Empty() const { return m_Head.load(std::memory_order_relaxed) == nullptr; }
+};
+
+enum class ChunkTaskType {
+	GENERATE = 0, // Generate the blocks of a new chunk
+	MESH,         // Build the mesh of a loaded chunk
+};
+
+/*
+ * Finished task. Generated chunks come back without a mesh, they are meshed
+ * once their neighbours are known. Meshes come back on their own, the loaded
+ * chunk only takes one if its blocks haven't changed since it was built (see
+ * ChunkMeshData::revision).
+ */
+struct ChunkBuildResult {
+	ChunkTaskType type;
+	glm::ivec2 position;
+	std::optional<Chunk> chunk; // Generated chunks only
+	ChunkMeshData mesh;         // Meshed chunks only
+};
+
+/*
+ * Worker threads that generate chunk blocks and build their meshes. Requests
+ * and results are owned by the render thread: it calls Request or Mesh, then
+ * Collect each frame to upload whatever finished. The generator is called
+ * from the workers, so it has to be thread safe. With storage, chunks that
+ * were saved before are read back instead of generated. A chunk has at most
+ * one task queued or running at a time. Meshes handed back through Recycle
+ * are built into again, so once enough have come back the workers stop
+ * allocating mesh arrays. Each Mesh call still copies the chunk's sections
+ * and borders for the worker.
+ */
+class ChunkWorkerPool {
+private:
+	struct Task {
+		ChunkTaskType type;
+		glm::ivec2 position;
+		MeshingMode mode;
+		std::optional<Chunk> chunk; // Copy of the chunk to mesh, taken at its current revision
+		ChunkBorders borders;
+	};
+
+	ChunkGeneratorFn m_Generator;
+	WorldSettings m_Settings;
+	ChunkStorage* m_Storage;
+
+	/* Pending tasks, workers sleep on the condition variable while empty */
+	std::mutex m_TaskMutex;
+	std::condition_variable m_TaskCondition;
+	std::deque<Task> m_Tasks;
+	bool m_Stopping;
+
+	CompletionQueue<ChunkBuildResult> m_Results;
+	std::vector<std::thread> m_Threads;
+
+	/* Positions requested but not collected yet, render thread only */
+	std::unordered_set<uint64_t> m_Pending;
+
+	/* Uploaded meshes whose arrays new meshes are built into */
+	std::mutex m_RecycleMutex;
+	std::vector<ChunkMeshData> m_Recycled;
+
+	void WorkerLoop();
+
+public:
+	/* Zero threads uses every core but the render thread's, storage is optional and has to outlive the pool */
+	ChunkWorkerPool(ChunkGeneratorFn generator, const WorldSettings& settings, size_t threads = 0, ChunkStorage* storage = nullptr);
+	~ChunkWorkerPool();
+
+	/* Delete copying */
+	ChunkWorkerPool(const ChunkWorkerPool&) = delete;
+	ChunkWorkerPool& operator=(const ChunkWorkerPool&) = delete;
+
+	/* Queue generating a chunk, ignored if it's already pending */
+	void Request(glm::ivec2 position);
+
+	/* Queue meshing a loaded chunk against its neighbours' borders, false if it's already pending */
+	bool Mesh(const Chunk& chunk, ChunkBorders&& borders, MeshingMode mode);
+
+	/* Drop a task no worker has started yet, false if there is none or it's already running */
+	bool Cancel(glm::ivec2 position);
+
+	bool IsPending(glm::ivec2 position) const;
+
+	/* Hand back a mesh that is done with, later meshes reuse its arrays instead of allocating their own */
+	void Recycle(ChunkMeshData&& mesh);
+
+	/* Hand finished chunks to fn in completion order, returns how many there were */
+	template <typename Fn>
+	size_t Collect(Fn&& fn) {
+		return m_Results.Drain([&](ChunkBuildResult&& result) {
+			m_Pending.erase(PackChunkKey(result.position));
+			fn(std::move(result));
+		});
+	}
+
+	inline size_t GetPendingCount() const { return m_Pending.size(); }
+	inline size_t GetThreadCount() const { return m_Threads.size(); }
+};
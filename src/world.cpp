@@ -1,342 +1,271 @@
 #include "world.h"
 
-#include <iostream>
+#include <algorithm>
+#include <stdexcept>
 
 #include "renderer/arrays.h"
 
-const char* BlockTypeToString(BlockType type) {
-	switch (type) {
-	case BlockType::AIR:
-		return "AIR";
-	case BlockType::DIRT:
-		return "DIRT";
-	case BlockType::GRASS:
-		return "GRASS";
-	case BlockType::STONE:
-		return "STONE";
-	case BlockType::WOOD:
-		return "WOOD";
-	case BlockType::LEAVES:
-		return "LEAVES";
-	case BlockType::COBBLESTONE:
-		return "COBBLESTONE";
-	case BlockType::BEDROCK:
-		return "BEDROCK";
-	default:
-		return "UNKNOWN";
+ChunkSection::ChunkSection(const BlockType* blocks) : m_NonAirCount(0), m_OpaqueCount(0) {
+	for (int i = 0; i < SECTION_VOLUME; i++) {
+		if (blocks[i] != BlockType::AIR) {
+			m_NonAirCount++;
+		}
+
+		if (IsBlockOpaque(blocks[i])) {
+			m_OpaqueCount++;
+		}
+	}
+
+	if (m_NonAirCount > 0) {
+		m_Blocks = std::make_unique<PalettedContainer>(blocks, SECTION_VOLUME);
 	}
 }
 
-BlockTexture GetBlockTexture(std::shared_ptr<render::Texture> terrain, BlockType type, BlockFace face) {
-	const glm::vec3 defaultColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	const int atlasCount = 16;
-
-	switch (type) {
-	case BlockType::GRASS:
-		switch (face) {
-		case BlockFace::TOP:
-			return { terrain->GetTextureCoords(0, atlasCount), glm::vec3(0.7f, 1.0f, 0.4f)};
-		case BlockFace::BOTTOM:
-			return { terrain->GetTextureCoords(2, atlasCount), defaultColor};
-		default:
-			return { terrain->GetTextureCoords(3, atlasCount), defaultColor };
-		}
-	case BlockType::DIRT:
-		return { terrain->GetTextureCoords(2, atlasCount), defaultColor };
-	case BlockType::STONE:
-		return { terrain->GetTextureCoords(1, atlasCount), defaultColor };
-	case BlockType::WOOD:
-		switch (face) {
-		case BlockFace::TOP:
-		case BlockFace::BOTTOM:
-			return { terrain->GetTextureCoords(21, atlasCount), defaultColor };
-		default:
-			return { terrain->GetTextureCoords(20, atlasCount), defaultColor };
-		}
-	case BlockType::LEAVES:
-		return { terrain->GetTextureCoords(53, atlasCount), glm::vec3(0.7f, 1.0f, 0.4f) };
-	case BlockType::COBBLESTONE:
-		return { terrain->GetTextureCoords(16, atlasCount), defaultColor };
-	case BlockType::BEDROCK:
-		return { terrain->GetTextureCoords(17, atlasCount), defaultColor };
-	default:
-		return { terrain->GetTextureCoords(31, atlasCount), defaultColor };
+void ChunkSection::SetBlock(int x, int y, int z, BlockType type) {
+	BlockType previous = GetBlock(x, y, z);
+	if (previous == type) {
+		return;
+	}
+
+	/* Allocate storage on first block */
+	if (!m_Blocks) {
+		m_Blocks = std::make_unique<PalettedContainer>(SECTION_VOLUME, BlockType::AIR);
+	}
+
+	m_Blocks->Set(GetBlockIndex(x, y, z, SECTION_SIZE, SECTION_SIZE, SECTION_SIZE), type);
+
+	if (previous == BlockType::AIR) {
+		m_NonAirCount++;
+	} else if (type == BlockType::AIR) {
+		m_NonAirCount--;
+	}
+
+	m_OpaqueCount += static_cast<int>(IsBlockOpaque(type)) - static_cast<int>(IsBlockOpaque(previous));
+
+	/* Release storage once the section is empty again */
+	if (m_NonAirCount == 0) {
+		m_Blocks.reset();
 	}
 }
 
-std::optional<BlockTexture> GetBlockOverTexture(std::shared_ptr<render::Texture> terrain, BlockType type, BlockFace face) {
-	const glm::vec3 defaultColor = glm::vec3(1.0f, 1.0f, 1.0f);
-	const int atlasCount = 16;
+ChunkSection ChunkSection::Clone() const {
+	ChunkSection copy;
+	copy.m_NonAirCount = m_NonAirCount;
+	copy.m_OpaqueCount = m_OpaqueCount;
+	if (m_Blocks) {
+		copy.m_Blocks = std::make_unique<PalettedContainer>(*m_Blocks);
+	}
 
-	switch (type) {
-		case BlockType::GRASS:
-			if (face != BlockFace::TOP && face != BlockFace::BOTTOM) {
-				return BlockTexture{ terrain->GetTextureCoords(38, atlasCount), glm::vec3(1.0f, 0.4f, 0.7f) /* glm::vec3(0.7f, 1.0f, 0.4f) */ };
-			}
+	return copy;
+}
+
+void ChunkSection::Decode(BlockType* out) const {
+	if (!m_Blocks) {
+		std::fill(out, out + SECTION_VOLUME, BlockType::AIR);
+		return;
 	}
-	
-	return std::nullopt;
+
+	m_Blocks->Decode(out);
 }
 
-bool InChunkBounds(int x, int y, int z, int width, int height, int depth) {
-	return x >= 0 && x < width && y >= 0 && y < height && z >= 0 && z < depth;
+size_t ChunkSection::GetMemoryUsage() const {
+	return sizeof(*this) + (m_Blocks ? m_Blocks->GetMemoryUsage() : 0);
 }
 
-bool InChunkHeightBounds(int x, int y, int z, int width, int height, int depth) {
-	return (z >= 0 && z < depth) && (x >= 0 && x < width);
+Chunk::Chunk(glm::ivec2 position)
+	: m_Position(position), m_Meshed(false), m_MeshNeighbours(0), m_Revision(0), m_SavedRevision(~0u) {}
+
+Chunk::Chunk(glm::ivec2 position, const std::vector<BlockType>& blocks, int width, int height, int depth)
+	: m_Position(position), m_Meshed(false), m_MeshNeighbours(0), m_Revision(0), m_SavedRevision(~0u) {
+	if (width != SECTION_SIZE || depth != SECTION_SIZE || height % SECTION_SIZE != 0) {
+		throw std::runtime_error("chunk dimensions must be a whole number of sections");
+	}
+
+	if (height > MAX_CHUNK_HEIGHT) {
+		throw std::runtime_error("chunk height doesn't fit the packed vertex format");
+	}
+
+	/* Split into sections */
+	std::vector<BlockType> scratch(SECTION_VOLUME);
+	m_Sections.reserve(height / SECTION_SIZE);
+
+	for (int section = 0; section < height / SECTION_SIZE; section++) {
+		for (int z = 0; z < SECTION_SIZE; z++) {
+			for (int y = 0; y < SECTION_SIZE; y++) {
+				const BlockType* row = &blocks[GetBlockIndex(0, section * SECTION_SIZE + y, z, width, height, depth)];
+				std::copy(row, row + SECTION_SIZE, &scratch[GetBlockIndex(0, y, z, SECTION_SIZE, SECTION_SIZE, SECTION_SIZE)]);
+			}
+		}
+
+		m_Sections.emplace_back(scratch.data());
+	}
+
+	m_Meshes.resize(m_Sections.size());
 }
 
-size_t GetBlockIndex(int x, int y, int z, int width, int height, int depth) {
-	return static_cast<size_t>(x) + (static_cast<size_t>(y) * width) + (static_cast<size_t>(z) * width * height);
+void Chunk::SetBlock(int x, int y, int z, BlockType type) {
+	if (x < 0 || x >= SECTION_SIZE || z < 0 || z >= SECTION_SIZE || y < 0 || y >= GetHeight()) {
+		return;
+	}
+
+	ChunkSection& section = m_Sections[y / SECTION_SIZE];
+	if (section.GetBlock(x, y % SECTION_SIZE, z) == type) {
+		return;
+	}
+
+	section.SetBlock(x, y % SECTION_SIZE, z, type);
+	m_Revision++;
 }
 
-BlockType GetBlockType(const std::vector<BlockType>& blocks, int x, int y, int z, int width, int height, int depth) {
-	if (!InChunkBounds(x, y, z, width, height, depth)) {
-		return BlockType::AIR;
+MeshStats Chunk::GetMeshStats() const {
+	MeshStats total;
+	for (const SectionMesh& mesh : m_Meshes) {
+		total.faces += mesh.stats.faces;
+		total.quads += mesh.stats.quads;
+		total.vertices += mesh.stats.vertices;
+		total.indices += mesh.stats.indices;
 	}
 
-	size_t index = GetBlockIndex(x, y, z, width, height, depth);
-	return blocks[index];
+	return total;
 }
 
-std::pair<glm::ivec2, glm::ivec3> GlobalToChunkPosition(glm::vec3 position, int width, int height, int depth) {
-	glm::ivec2 chunk = glm::ivec2(floor(position.x / width), floor(position.z / depth));
-	glm::ivec3 block = glm::ivec3(static_cast<int>(position.x) - chunk.x * width, position.y, static_cast<int>(position.z) - chunk.y * depth);
+void Chunk::SetSectionMesh(int index, render::ArenaAllocation&& mesh, const MeshStats& stats) {
+	m_Meshes[index].allocation = std::move(mesh);
+	m_Meshes[index].stats = stats;
+}
 
-	return { chunk, block };
+void Chunk::ClearMesh() {
+	for (SectionMesh& mesh : m_Meshes) {
+		mesh = {};
+	}
+
+	m_Meshed = false;
+	m_MeshNeighbours = 0;
+}
+
+void Chunk::SetMeshed(uint8_t neighbours) {
+	m_Meshed = true;
+	m_MeshNeighbours = neighbours;
 }
 
-std::pair<std::vector<BlockVertex>, std::vector<unsigned int>> CreateBlockFace(std::shared_ptr<render::Texture> terrain, BlockType type, BlockFace face, glm::vec3 position, glm::vec3 normal) {
-	std::vector<BlockVertex> vertices;
-	std::vector<unsigned int> indices;
-
-	/* Get block texture */
-	BlockTexture texture = GetBlockTexture(terrain, type, face);
-	std::optional<BlockTexture> overTexture = GetBlockOverTexture(terrain, type, face);
-
-	{
-		/* Get color */
-		glm::vec3 color = texture.color;
-
-		/* Get texture coordinates */
-		glm::vec2 bottomLeft = glm::vec2(texture.coords.min_x, texture.coords.min_y);
-		glm::vec2 bottomRight = glm::vec2(texture.coords.max_x, texture.coords.min_y);
-		glm::vec2 topRight = glm::vec2(texture.coords.max_x, texture.coords.max_y);
-		glm::vec2 topLeft = glm::vec2(texture.coords.min_x, texture.coords.max_y);
-
-		/* Add vertices */
-		switch (face) {
-		case BlockFace::FRONT:
-			vertices.push_back({ position + glm::vec3(0, 0, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(1, 0, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 1), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 1), normal, color, topLeft });
-			break;
-		case BlockFace::BACK:
-			vertices.push_back({ position + glm::vec3(1, 0, 0), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(0, 0, 0), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 0), normal, color, topLeft });
-			break;
-		case BlockFace::LEFT:
-			vertices.push_back({ position + glm::vec3(0, 0, 0), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(0, 0, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 1), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 0), normal, color, topLeft });
-			break;
-		case BlockFace::RIGHT:
-			vertices.push_back({ position + glm::vec3(1, 0, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(1, 0, 0), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 1), normal, color, topLeft });
-			break;
-		case BlockFace::TOP:
-			vertices.push_back({ position + glm::vec3(0, 1, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(1, 1, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 0), normal, color, topLeft });
-			break;
-		case BlockFace::BOTTOM:
-			vertices.push_back({ position + glm::vec3(1, 0, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(0, 0, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(0, 0, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(1, 0, 0), normal, color, topLeft });
-			break;
+void Chunk::Decode(std::vector<BlockType>& out) const {
+	const int height = GetHeight();
+	std::vector<BlockType> scratch(SECTION_VOLUME);
+	out.resize(static_cast<size_t>(SECTION_SIZE) * height * SECTION_SIZE);
+
+	for (int section = 0; section < GetSectionCount(); section++) {
+		m_Sections[section].Decode(scratch.data());
+		for (int z = 0; z < SECTION_SIZE; z++) {
+			for (int y = 0; y < SECTION_SIZE; y++) {
+				const BlockType* row = &scratch[GetBlockIndex(0, y, z, SECTION_SIZE, SECTION_SIZE, SECTION_SIZE)];
+				std::copy(row, row + SECTION_SIZE, &out[GetBlockIndex(0, section * SECTION_SIZE + y, z, SECTION_SIZE, height, SECTION_SIZE)]);
+			}
 		}
+	}
+}
 
-		/* Adding indices */
-		indices.push_back(0);
-		indices.push_back(1);
-		indices.push_back(2);
-		indices.push_back(2);
-		indices.push_back(3);
-		indices.push_back(0);
+Chunk Chunk::CopyBlocks() const {
+	Chunk copy(m_Position);
+	copy.m_Revision = m_Revision;
+	copy.m_SavedRevision = m_SavedRevision;
+	copy.m_Sections.reserve(m_Sections.size());
+	for (const ChunkSection& section : m_Sections) {
+		copy.m_Sections.push_back(section.Clone());
 	}
 
-	if (overTexture.has_value()) {
-		BlockTexture texture = overTexture.value();
-
-		/* Get color */
-		glm::vec3 color = texture.color;
-
-		/* Get texture coordinates */
-		glm::vec2 bottomLeft = glm::vec2(texture.coords.min_x, texture.coords.min_y);
-		glm::vec2 bottomRight = glm::vec2(texture.coords.max_x, texture.coords.min_y);
-		glm::vec2 topRight = glm::vec2(texture.coords.max_x, texture.coords.max_y);
-		glm::vec2 topLeft = glm::vec2(texture.coords.min_x, texture.coords.max_y);
-
-		/* Add vertices */
-		switch (face) {
-		case BlockFace::FRONT:
-			vertices.push_back({ position + glm::vec3(0, 0, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(1, 0, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 1), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 1), normal, color, topLeft });
-			break;
-		case BlockFace::BACK:
-			vertices.push_back({ position + glm::vec3(1, 0, 0), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(0, 0, 0), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 0), normal, color, topLeft });
-			break;
-		case BlockFace::LEFT:
-			vertices.push_back({ position + glm::vec3(0, 0, 0), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(0, 0, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 1), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 0), normal, color, topLeft });
-			break;
-		case BlockFace::RIGHT:	
-			vertices.push_back({ position + glm::vec3(1, 0, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(1, 0, 0), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 1), normal, color, topLeft });
-			break;
-		case BlockFace::TOP:
-			vertices.push_back({ position + glm::vec3(0, 1, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(1, 1, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(1, 1, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(0, 1, 0), normal, color, topLeft });
-			break;
-		case BlockFace::BOTTOM:
-			vertices.push_back({ position + glm::vec3(1, 0, 1), normal, color, bottomLeft });
-			vertices.push_back({ position + glm::vec3(0, 0, 1), normal, color, bottomRight });
-			vertices.push_back({ position + glm::vec3(0, 0, 0), normal, color, topRight });
-			vertices.push_back({ position + glm::vec3(1, 0, 0), normal, color, topLeft });
-			break;
-		}
+	copy.m_Meshes.resize(m_Sections.size());
+	return copy;
+}
+
+bool Chunk::IsSectionOccluded(int index) const {
+	/* Only a section filled with opaque blocks can hide all of its faces */
+	if (!m_Sections[index].IsOpaque()) {
+		return false;
+	}
+
+	/* Horizontal neighbours live in other chunks, the mesher checks those against its border slices */
+	if (index == 0 || !m_Sections[index - 1].IsOpaque()) {
+		return false;
+	}
 
-		/* Adding indices */
-		int offset = vertices.size() - 4;
-		indices.push_back(0 + offset);
-		indices.push_back(1 + offset);
-		indices.push_back(2 + offset);
-		indices.push_back(2 + offset);
-		indices.push_back(3 + offset);
-		indices.push_back(0 + offset);
+	if (index + 1 >= GetSectionCount() || !m_Sections[index + 1].IsOpaque()) {
+		return false;
 	}
-	
-	return { std::move(vertices), std::move(indices) };
+
+	return true;
 }
 
-render::Mesh CreateChunkMesh(std::shared_ptr<render::Texture> terrain, const std::vector<BlockType>& blocks, glm::ivec2 chunk, int width, int height, int depth) {
-	constexpr int directions[][3] = {
-		{  0,  0,  1 },
-		{  0,  0, -1 },
-		{ -1,  0,  0 },
-		{  1,  0,  0 },
-		{  0,  1,  0 },
-		{  0, -1,  0 },
-	};
-	
-	std::vector<BlockVertex> vertices;
-	std::vector<unsigned int> indices;
-	glm::vec3 inChunk = glm::vec3(chunk.x * width, 0, chunk.y * depth);
-
-	for (int y = 0; y < height; y++) {
-		for (int z = 0; z < depth; z++) {
-			for (int x = 0; x < width; x++) {
-				/* Get block type */
-				BlockType type = GetBlockType(blocks, x, y, z, width, height, depth);
-				if (type == BlockType::AIR) {
-					continue;
-				}
-
-				/* Check for faces */
-				for (int direction = 0; direction < 6; direction++) {
-					BlockFace face = static_cast<BlockFace>(direction);
-
-					int nx = x + directions[direction][0];
-					int ny = y + directions[direction][1];
-					int nz = z + directions[direction][2];
-
-					if (!InChunkHeightBounds(nx, ny, nz, width, height, depth)) {
-						continue;
-					}
-
-					BlockType neighbor = GetBlockType(blocks, nx, ny, nz, width, height, depth);
-					if (neighbor == BlockType::AIR) {
-						glm::vec3 position = glm::vec3(x, y, z) + inChunk;
-						glm::vec3 normal = glm::vec3(directions[direction][0], directions[direction][1], directions[direction][2]);
-
-						auto [faceVertices, faceIndices] = CreateBlockFace(terrain, type, face, position, normal);
-						for (const auto& vertex : faceVertices) {
-							vertices.push_back(vertex);
-						}
-
-						int offset = vertices.size() - faceVertices.size();
-						for (const auto& index : faceIndices) {
-							indices.push_back(index + offset);
-						}
-					}
-				}
-			}
+AABB Chunk::GetBounds() const {
+	/* Only the span of non-empty sections can produce geometry */
+	int lowest = GetSectionCount();
+	int highest = -1;
+	for (int i = 0; i < GetSectionCount(); i++) {
+		if (!m_Sections[i].IsEmpty()) {
+			lowest = std::min(lowest, i);
+			highest = i;
 		}
 	}
 
-	/* Create layout */
-	render::VertexBufferLayout layout;
-	layout.Push<float>(3); // Position
-	layout.Push<float>(3); // Normal
-	layout.Push<float>(3); // Color
-	layout.Push<float>(2); // Texcoord
+	glm::vec3 origin = glm::vec3(m_Position.x * SECTION_SIZE, 0.0f, m_Position.y * SECTION_SIZE);
+	if (highest < 0) {
+		return { origin, origin };
+	}
 
-	// std::cerr << "Creating mesh with " << vertices.size() << " vertices and " << indices.size() << " indices" << std::endl;
+	return {
+		origin + glm::vec3(0.0f, lowest * SECTION_SIZE, 0.0f),
+		origin + glm::vec3(SECTION_SIZE, (highest + 1) * SECTION_SIZE, SECTION_SIZE),
+	};
+}
 
-	/* Create mesh */
-	return render::Mesh(layout, vertices, indices, { terrain });
+AABB Chunk::GetSectionBounds(int index) const {
+	glm::vec3 origin = glm::vec3(m_Position.x * SECTION_SIZE, index * SECTION_SIZE, m_Position.y * SECTION_SIZE);
+	return { origin, origin + glm::vec3(SECTION_SIZE) };
 }
 
+size_t Chunk::GetMemoryUsage() const {
+	size_t usage = sizeof(*this);
+	for (const auto& section : m_Sections) {
+		usage += section.GetMemoryUsage();
+	}
 
-bool Raycast(const WorldSettings& settings, const std::vector<std::tuple<glm::ivec2, Chunk>>& chunks, glm::vec3 position, glm::vec3 direction, float distance, RaycastResult& result) {
-	/* Raycast */
-	for (float i = 0; i < distance; i += 0.1f) {
-		glm::vec3 check = position + direction * i;
-
-		auto [current_chunk, current_block] = GlobalToChunkPosition(check, settings.chunk_width, settings.chunk_height, settings.chunk_depth);
-		for (const auto& [position, chunk] : chunks) {
-			if (position.x == current_chunk.x && position.y == current_chunk.y) {
-				/* Get block type */
-				const std::vector<BlockType>& blocks = chunk.GetBlocks();
-	
-				/* Check block type */
-				BlockType type = GetBlockType(blocks, current_block.x, current_block.y, current_block.z, settings.chunk_width, settings.chunk_height, settings.chunk_depth);
-				
-				/*
-				std::cout 
-					<< "Chunk: " << position.x << ", " << position.y << " - "
-					<< "Block: " << current_block.x << ", " << current_block.y << ", " << current_block.z 
-					<< " = " << BlockTypeToString(type) << std::endl;
-				*/
-
-				if (type != BlockType::AIR) {
-					result.position = check;
-					result.normal = glm::vec3(0.0f, 0.0f, 0.0f);
-					result.type = type;
-					return true;
-				}
-			}
-		}
+	return usage;
+}
+
+glm::vec3 GetTintColor(BlockTint tint) {
+	switch (tint) {
+	case BlockTint::FOLIAGE:
+		return glm::vec3(0.7f, 1.0f, 0.4f);
+	case BlockTint::OVERLAY:
+		return glm::vec3(1.0f, 0.4f, 0.7f) /* glm::vec3(0.7f, 1.0f, 0.4f) */;
+	default:
+		return glm::vec3(1.0f, 1.0f, 1.0f);
+	}
+}
+
+bool InChunkBounds(int x, int y, int z, int width, int height, int depth) {
+	return x >= 0 && x < width && y >= 0 && y < height && z >= 0 && z < depth;
+}
+
+bool InChunkHeightBounds(int x, int y, int z, int width, int height, int depth) {
+	return (z >= 0 && z < depth) && (x >= 0 && x < width);
+}
+
+size_t GetBlockIndex(int x, int y, int z, int width, int height, int depth) {
+	return static_cast<size_t>(x) + (static_cast<size_t>(y) * width) + (static_cast<size_t>(z) * width * height);
+}
+
+BlockType GetBlockType(const std::vector<BlockType>& blocks, int x, int y, int z, int width, int height, int depth) {
+	if (!InChunkBounds(x, y, z, width, height, depth)) {
+		return BlockType::AIR;
 	}
 
-	return false;
+	size_t index = GetBlockIndex(x, y, z, width, height, depth);
+	return blocks[index];
+}
+
+std::pair<glm::ivec2, glm::ivec3> GlobalToChunkPosition(glm::vec3 position, int width, int height, int depth) {
+	glm::ivec2 chunk = glm::ivec2(floor(position.x / width), floor(position.z / depth));
+	glm::ivec3 block = glm::ivec3(static_cast<int>(position.x) - chunk.x * width, position.y, static_cast<int>(position.z) - chunk.y * depth);
+
+	return { chunk, block };
 }
\ No newline at end of file
@@ -1,45 +1,50 @@
 #pragma once
 
 #include <vector>
+#include <memory>
+#include <cstdint>
 #include <optional>
 #include <functional>
 
 #include <renderer/textures.h>
 #include <renderer/buffers.h>
 #include <renderer/models.h>
+#include <renderer/arena.h>
 
-enum class BlockType {
-	AIR = 0,
-	DIRT,
-	GRASS,
-	STONE,
-	WOOD,
-	LEAVES,
-	COBBLESTONE,
-	BEDROCK,
-};
+#include "blocks.h"
+#include "palette.h"
+#include "frustum.h"
 
-const char* BlockTypeToString(BlockType type);
+glm::vec3 GetTintColor(BlockTint tint);
 
-enum class BlockFace {
-	FRONT = 0,
-	BACK,
-	LEFT,
-	RIGHT,
-	TOP,
-	BOTTOM,
-};
+/*
+ * Chunk mesh vertex packed into two words, decoded in world.vert.
+ * position: x (5 bits) | z (5 bits) << 5 | y (9 bits) << 10 | face (3 bits) << 19, chunk local
+ * material: texture layer (8 bits) | tint (3 bits) << 8
+ */
+struct ChunkVertex {
+	uint32_t position;
+	uint32_t material;
+
+	static constexpr uint32_t Pack(int x, int y, int z, BlockFace face) {
+		return static_cast<uint32_t>(x) | (static_cast<uint32_t>(z) << 5) | (static_cast<uint32_t>(y) << 10) | (static_cast<uint32_t>(face) << 19);
+	}
 
-struct BlockTexture {
-	render::TextureCoords coords;
-	glm::vec3 color;
+	static constexpr uint32_t PackMaterial(int tile, BlockTint tint) {
+		return static_cast<uint32_t>(tile) | (static_cast<uint32_t>(tint) << 8);
+	}
 };
 
-struct BlockVertex {
-	glm::vec3 position;
-	glm::vec3 normal;
-	glm::vec3 color;
-	glm::vec2 texcoord;
+static_assert(sizeof(ChunkVertex) == 8, "chunk vertices must stay packed");
+
+/* Highest y a packed vertex can hold */
+constexpr int MAX_CHUNK_HEIGHT = 511;
+
+struct MeshStats {
+	size_t faces = 0;    // Quads one per exposed block face would need
+	size_t quads = 0;    // Quads actually emitted
+	size_t vertices = 0;
+	size_t indices = 0;
 };
 
 struct WorldSettings {
@@ -47,64 +52,161 @@ struct WorldSettings {
 	int chunk_height;
 	int chunk_depth;
 	int render_distance;
+	int unload_distance; // Loaded chunks are kept until they're this far, at least render_distance
 };
 
-struct RaycastResult {
-	glm::vec3 position;
-	glm::vec3 normal;
-	BlockType type;
+/* Chunks are split vertically into cubic sections */
+constexpr int SECTION_SIZE = 16;
+constexpr int SECTION_VOLUME = SECTION_SIZE * SECTION_SIZE * SECTION_SIZE;
+
+class ChunkSection {
+private:
+	/* Empty sections allocate no block storage */
+	std::unique_ptr<PalettedContainer> m_Blocks;
+	int m_NonAirCount;
+	int m_OpaqueCount;
+
+public:
+	ChunkSection() : m_NonAirCount(0), m_OpaqueCount(0) {}
+	ChunkSection(const BlockType* blocks);
+
+	/* Delete copying */
+	ChunkSection(const ChunkSection&) = delete;
+	ChunkSection& operator=(const ChunkSection&) = delete;
+
+	/* Allow moving */
+	ChunkSection(ChunkSection&&) noexcept = default;
+	ChunkSection& operator=(ChunkSection&&) noexcept = default;
+
+	/* Block access in section local coordinates */
+	inline BlockType GetBlock(int x, int y, int z) const {
+		if (!m_Blocks) {
+			return BlockType::AIR;
+		}
+
+		return m_Blocks->Get(static_cast<size_t>(x) + static_cast<size_t>(y) * SECTION_SIZE + static_cast<size_t>(z) * SECTION_SIZE * SECTION_SIZE);
+	}
+
+	void SetBlock(int x, int y, int z, BlockType type);
+
+	/* Copy of the block storage, copies are explicit so sections aren't duplicated by accident */
+	ChunkSection Clone() const;
+
+	/* Decode SECTION_VOLUME blocks into out */
+	void Decode(BlockType* out) const;
+
+	/* Getters */
+	inline int GetNonAirCount() const { return m_NonAirCount; }
+	inline bool IsEmpty() const { return m_NonAirCount == 0; }
+	inline bool IsFull() const { return m_NonAirCount == SECTION_VOLUME; }
+	inline bool IsOpaque() const { return m_OpaqueCount == SECTION_VOLUME; }
+	inline const PalettedContainer* GetBlocks() const { return m_Blocks.get(); }
+	size_t GetMemoryUsage() const;
+};
+
+/* Geometry of one section, drawn on its own so an edit only rebuilds the sections it touches */
+struct SectionMesh {
+	render::ArenaAllocation allocation; // Invalid when the section has nothing to draw
+	MeshStats stats;
 };
 
 class Chunk {
 private:
     glm::ivec2 m_Position;
-    render::Mesh m_Mesh;
-    std::vector<BlockType> m_Blocks;
+    std::vector<SectionMesh> m_Meshes;
+    bool m_Meshed;
+    uint8_t m_MeshNeighbours; // Bit per horizontal neighbour that was loaded when the mesh was built
+    uint32_t m_Revision;      // Bumped by every block change, to spot meshes built from old blocks
+    uint32_t m_SavedRevision; // Revision last written to disk
+    std::vector<ChunkSection> m_Sections;
+
+    /* No sections, filled in by CopyBlocks */
+    Chunk(glm::ivec2 position);
 
 public:
-    Chunk(glm::ivec2 position, const std::vector<BlockType>& blocks, render::Mesh&& mesh) :
-		m_Position(position), m_Blocks(blocks), m_Mesh(std::move(mesh)) {}
+    Chunk(glm::ivec2 position, const std::vector<BlockType>& blocks, int width, int height, int depth);
 
 	/* Delete copying */
 	Chunk(const Chunk&) = delete;
 	Chunk& operator=(const Chunk&) = delete;
 
 	/* Allow moving */
-	Chunk(Chunk&& other) noexcept : m_Position(other.m_Position), m_Mesh(std::move(other.m_Mesh)), m_Blocks(std::move(other.m_Blocks)) {}
+	Chunk(Chunk&& other) noexcept
+		: m_Position(other.m_Position), m_Meshes(std::move(other.m_Meshes)), m_Meshed(other.m_Meshed),
+		  m_MeshNeighbours(other.m_MeshNeighbours), m_Revision(other.m_Revision), m_SavedRevision(other.m_SavedRevision),
+		  m_Sections(std::move(other.m_Sections)) {}
 	Chunk& operator=(Chunk&& other) noexcept {
 		if (this != &other) {
 			m_Position = other.m_Position;
-			m_Mesh = std::move(other.m_Mesh);
-			m_Blocks = std::move(other.m_Blocks);
+			m_Meshes = std::move(other.m_Meshes);
+			m_Meshed = other.m_Meshed;
+			m_MeshNeighbours = other.m_MeshNeighbours;
+			m_Revision = other.m_Revision;
+			m_SavedRevision = other.m_SavedRevision;
+			m_Sections = std::move(other.m_Sections);
 		}
 
 		return *this;
 	}
 
+	/* Block access in chunk local coordinates, out of bounds reads as air */
+	inline BlockType GetBlock(int x, int y, int z) const {
+		if (x < 0 || x >= SECTION_SIZE || z < 0 || z >= SECTION_SIZE || y < 0 || y >= GetHeight()) {
+			return BlockType::AIR;
+		}
+
+		return m_Sections[y / SECTION_SIZE].GetBlock(x, y % SECTION_SIZE, z);
+	}
+
+	void SetBlock(int x, int y, int z, BlockType type);
+
+	/* Decode every block in the layout the constructor takes */
+	void Decode(std::vector<BlockType>& out) const;
+
+	/* Copy of the sections and revision without any meshes, a copy of the packed storage rather than a decode */
+	Chunk CopyBlocks() const;
+
     const glm::ivec2& GetPosition() const { return m_Position; }
-    const render::Mesh& GetMesh() const { return m_Mesh; }
-    const std::vector<BlockType>& GetBlocks() const { return m_Blocks; }
+    uint32_t GetRevision() const { return m_Revision; }
 
-    void SetMesh(render::Mesh&& mesh) { m_Mesh = std::move(mesh); }
+	/* Persistence, a new chunk counts as unsaved until it's written or was read from disk */
+	inline bool IsSaved() const { return m_SavedRevision == m_Revision; }
+	inline void MarkSaved() { m_SavedRevision = m_Revision; }
+
+	/* Meshes, one per section */
+	inline bool HasMesh() const { return m_Meshed; }
+	inline const render::ArenaAllocation& GetSectionMesh(int index) const { return m_Meshes[index].allocation; }
+	inline uint8_t GetMeshNeighbours() const { return m_MeshNeighbours; }
+	MeshStats GetMeshStats() const;
+
+	void SetSectionMesh(int index, render::ArenaAllocation&& mesh, const MeshStats& stats = {});
+
+	/* Release every section mesh, the chunk draws nothing until it's meshed again */
+	void ClearMesh();
+
+	/* Mark the chunk drawable, with the neighbours its borders were culled against */
+	void SetMeshed(uint8_t neighbours);
+
+	/* Sections */
+	inline int GetSectionCount() const { return static_cast<int>(m_Sections.size()); }
+	inline int GetHeight() const { return GetSectionCount() * SECTION_SIZE; }
+	inline const ChunkSection& GetSection(int index) const { return m_Sections[index]; }
+	bool IsSectionOccluded(int index) const;
+	size_t GetMemoryUsage() const;
+
+	/* World space box around the non-empty sections */
+	AABB GetBounds() const;
+	AABB GetSectionBounds(int index) const;
 };
 
+class ChunkMap;
+
 /* Chunk Generation */
 using ChunkGeneratorFn = std::function<std::vector<BlockType>(glm::ivec2, int, int, int)>;
 
-/* Chunk helpers */
-BlockTexture GetBlockTexture(std::shared_ptr<render::Texture> terrain, BlockType type, BlockFace face);
-std::optional<BlockTexture> GetBlockOverTexture(std::shared_ptr<render::Texture> terrain, BlockType type, BlockFace face);	
-
 /* World Getters */
 bool InChunkBounds(int x, int y, int z, int width, int height, int depth);
 bool InChunkHeightBounds(int x, int y, int z, int width, int height, int depth);
 size_t GetBlockIndex(int x, int y, int z, int width, int height, int depth);
 BlockType GetBlockType(const std::vector<BlockType>& blocks, int x, int y, int z, int width, int height, int depth);
-std::pair<glm::ivec2, glm::ivec3> GlobalToChunkPosition(glm::vec3 position, int width, int height, int depth);
-
-/* Chunk rendering */
-std::pair<std::vector<BlockVertex>, std::vector<unsigned int>> CreateBlockFace(std::shared_ptr<render::Texture> terrain, BlockType type, BlockFace face, glm::vec3 position, glm::vec3 normal);
-render::Mesh CreateChunkMesh(std::shared_ptr<render::Texture> terrain, const std::vector<BlockType>& blocks, glm::ivec2 chunk, int width, int height, int depth);
-
-/* Raycast result */
-bool Raycast(const WorldSettings& settings, const std::vector<std::tuple<glm::ivec2, Chunk>>& chunks, glm::vec3 position, glm::vec3 direction, float distance, RaycastResult& result);
\ No newline at end of file
+std::pair<glm::ivec2, glm::ivec3> GlobalToChunkPosition(glm::vec3 position, int width, int height, int depth);
\ No newline at end of file